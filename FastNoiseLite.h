@@ -52,6 +52,16 @@
 
 #include <cmath>
 
+// Local addition: batched evaluation (GenUniformGrid2D/3D, GenPositionArray2D/3D) with AVX2 paths for Perlin and
+// OpenSimplex2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FNL_BATCH_AVX2 1
+#include <immintrin.h>
+#include <vector>
+#else
+#define FNL_BATCH_AVX2 0
+#endif
+
 class FastNoiseLite
 {
 public:
@@ -393,6 +403,179 @@ public:
         }
     }
 
+    /// <summary>
+    /// Fills noiseOut[xSize * ySize] with 2D noise on a regular grid, x fastest:
+    /// noiseOut[iy * xSize + ix] = GetNoise(xStart + ix * xStep, yStart + iy * yStep)
+    /// </summary>
+    /// <remarks>
+    /// Matches GetNoise with double coordinates. Perlin and OpenSimplex2 noise without fractal are evaluated 8 samples
+    /// at a time with AVX2 when the CPU supports it, every other setting falls back to one GetNoise call per sample.
+    /// </remarks>
+    void GenUniformGrid2D(float* noiseOut, double xStart, double yStart, int xSize, int ySize,
+                          double xStep = 1, double yStep = 1) const
+    {
+#if FNL_BATCH_AVX2
+        if (CanBatchPerlin(false) && HasAVX2())
+        {
+            PerlinAxis axisX(*this, xStart, xStep, xSize, PrimeX);
+            PerlinAxis axisY(*this, yStart, yStep, ySize, PrimeY);
+            for (int iy = 0; iy < ySize; iy++)
+            {
+                PerlinRow2D(noiseOut + iy * xSize, axisX, axisY, iy);
+            }
+            return;
+        }
+        if (CanBatchOpenSimplex2() && HasAVX2())
+        {
+            OpenSimplex2Batch2D<double>(noiseOut, xSize * ySize, [&](int index, double& x, double& y) {
+                x = xStart + (index % xSize) * xStep;
+                y = yStart + (index / xSize) * yStep;
+            });
+            return;
+        }
+#endif
+        for (int iy = 0; iy < ySize; iy++)
+        {
+            for (int ix = 0; ix < xSize; ix++)
+            {
+                *noiseOut++ = GetNoise(xStart + ix * xStep, yStart + iy * yStep);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Fills noiseOut[xSize * ySize * zSize] with 3D noise on a regular grid, x fastest then y:
+    /// noiseOut[(iz * ySize + iy) * xSize + ix] = GetNoise(xStart + ix * xStep, yStart + iy * yStep, zStart + iz * zStep)
+    /// </summary>
+    /// <remarks>
+    /// Same batching rules as GenUniformGrid2D, 3D Perlin additionally needs RotationType3D_None. 3D OpenSimplex2 is
+    /// batched with any rotation.
+    /// </remarks>
+    void GenUniformGrid3D(float* noiseOut, double xStart, double yStart, double zStart, int xSize, int ySize, int zSize,
+                          double xStep = 1, double yStep = 1, double zStep = 1) const
+    {
+#if FNL_BATCH_AVX2
+        if (CanBatchPerlin(true) && HasAVX2())
+        {
+            PerlinAxis axisX(*this, xStart, xStep, xSize, PrimeX);
+            PerlinAxis axisY(*this, yStart, yStep, ySize, PrimeY);
+            PerlinAxis axisZ(*this, zStart, zStep, zSize, PrimeZ);
+            for (int iz = 0; iz < zSize; iz++)
+            {
+                for (int iy = 0; iy < ySize; iy++)
+                {
+                    PerlinRow3D(noiseOut + (iz * ySize + iy) * xSize, axisX, axisY, iy, axisZ, iz);
+                }
+            }
+            return;
+        }
+        if (CanBatchOpenSimplex2() && HasAVX2())
+        {
+            OpenSimplex2Batch3D<double>(noiseOut, xSize * ySize * zSize, [&](int index, double& x, double& y, double& z) {
+                x = xStart + (index % xSize) * xStep;
+                y = yStart + (index / xSize % ySize) * yStep;
+                z = zStart + (index / (xSize * ySize)) * zStep;
+            });
+            return;
+        }
+#endif
+        for (int iz = 0; iz < zSize; iz++)
+        {
+            for (int iy = 0; iy < ySize; iy++)
+            {
+                for (int ix = 0; ix < xSize; ix++)
+                {
+                    *noiseOut++ = GetNoise(xStart + ix * xStep, yStart + iy * yStep, zStart + iz * zStep);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Fills noiseOut[count] with 2D noise at arbitrary positions: noiseOut[i] = GetNoise(xPos[i], yPos[i])
+    /// </summary>
+    template <typename FNfloat>
+    void GenPositionArray2D(float* noiseOut, int count, const FNfloat* xPos, const FNfloat* yPos) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+#if FNL_BATCH_AVX2
+        if (CanBatchPerlin(false) && HasAVX2())
+        {
+            PerlinLanes lanes;
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                for (int lane = 0; lane < 8; lane++)
+                {
+                    lanes.Set(*this, lane, xPos[i + lane], yPos[i + lane]);
+                }
+                PerlinLanes2D(noiseOut + i, lanes);
+            }
+            for (; i < count; i++)
+            {
+                noiseOut[i] = GetNoise(xPos[i], yPos[i]);
+            }
+            return;
+        }
+        if (CanBatchOpenSimplex2() && HasAVX2())
+        {
+            OpenSimplex2Batch2D<FNfloat>(noiseOut, count, [&](int index, FNfloat& x, FNfloat& y) {
+                x = xPos[index];
+                y = yPos[index];
+            });
+            return;
+        }
+#endif
+        for (int i = 0; i < count; i++)
+        {
+            noiseOut[i] = GetNoise(xPos[i], yPos[i]);
+        }
+    }
+
+    /// <summary>
+    /// Fills noiseOut[count] with 3D noise at arbitrary positions: noiseOut[i] = GetNoise(xPos[i], yPos[i], zPos[i])
+    /// </summary>
+    template <typename FNfloat>
+    void GenPositionArray3D(float* noiseOut, int count, const FNfloat* xPos, const FNfloat* yPos, const FNfloat* zPos) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+#if FNL_BATCH_AVX2
+        if (CanBatchPerlin(true) && HasAVX2())
+        {
+            PerlinLanes lanes;
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                for (int lane = 0; lane < 8; lane++)
+                {
+                    lanes.Set(*this, lane, xPos[i + lane], yPos[i + lane], zPos[i + lane]);
+                }
+                PerlinLanes3D(noiseOut + i, lanes);
+            }
+            for (; i < count; i++)
+            {
+                noiseOut[i] = GetNoise(xPos[i], yPos[i], zPos[i]);
+            }
+            return;
+        }
+        if (CanBatchOpenSimplex2() && HasAVX2())
+        {
+            OpenSimplex2Batch3D<FNfloat>(noiseOut, count, [&](int index, FNfloat& x, FNfloat& y, FNfloat& z) {
+                x = xPos[index];
+                y = yPos[index];
+                z = zPos[index];
+            });
+            return;
+        }
+#endif
+        for (int i = 0; i < count; i++)
+        {
+            noiseOut[i] = GetNoise(xPos[i], yPos[i], zPos[i]);
+        }
+    }
+
 private:
     template <typename T>
     struct Arguments_must_be_floating_point_values;
@@ -1655,7 +1838,7 @@ private:
                             distance0 = newDistance;
                             closestHash = hash;
                         }
-                        zPrimed += PrimeZ;
+                        zPrimed = (int)((unsigned)zPrimed + (unsigned)PrimeZ);
                     }
                     yPrimed += PrimeY;
                 }
@@ -1688,7 +1871,7 @@ private:
                             distance0 = newDistance;
                             closestHash = hash;
                         }
-                        zPrimed += PrimeZ;
+                        zPrimed = (int)((unsigned)zPrimed + (unsigned)PrimeZ);
                     }
                     yPrimed += PrimeY;
                 }
@@ -1721,7 +1904,7 @@ private:
                             distance0 = newDistance;
                             closestHash = hash;
                         }
-                        zPrimed += PrimeZ;
+                        zPrimed = (int)((unsigned)zPrimed + (unsigned)PrimeZ);
                     }
                     yPrimed += PrimeY;
                 }
@@ -2442,6 +2625,485 @@ private:
         yr += vy * warpAmp;
         zr += vz * warpAmp;
     }
+
+#if FNL_BATCH_AVX2
+    // Batched Perlin, see GenUniformGrid2D. Every coordinate is split into lattice cell and fade on the scalar side
+    // exactly like SinglePerlin does it, the vector kernels then repeat SinglePerlin's float math operation for
+    // operation, so batched and single results are identical as long as the compiler doesn't fuse multiply-adds (an FMA
+    // target without -ffp-contract=off).
+
+    static bool HasAVX2()
+    {
+        static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+        return hasAVX2;
+    }
+
+    bool CanBatchPerlin(bool is3D) const
+    {
+        return mNoiseType == NoiseType_Perlin && mFractalType == FractalType_None && (!is3D || mTransformType3D == TransformType3D_None);
+    }
+
+    template <typename FNfloat>
+    void PerlinSplit(FNfloat v, int prime, int& primed, float& d0, float& s) const
+    {
+        v *= mFrequency;
+        int v0 = FastFloor(v);
+        d0 = (float)(v - v0);
+        s = InterpQuintic(d0);
+        primed = v0 * prime;
+    }
+
+    // One axis of a uniform grid, split once per sample along the axis instead of once per grid point
+    struct PerlinAxis
+    {
+        std::vector<int> primed;
+        std::vector<float> d0;
+        std::vector<float> s;
+
+        PerlinAxis(const FastNoiseLite& noise, double start, double step, int size, int prime) : primed(size), d0(size), s(size)
+        {
+            for (int i = 0; i < size; i++)
+            {
+                noise.PerlinSplit(start + i * step, prime, primed[i], d0[i], s[i]);
+            }
+        }
+    };
+
+    // Eight arbitrary positions, split
+    struct PerlinLanes
+    {
+        int xPrimed[8], yPrimed[8], zPrimed[8];
+        float xd0[8], yd0[8], zd0[8];
+        float xs[8], ys[8], zs[8];
+
+        template <typename FNfloat>
+        void Set(const FastNoiseLite& noise, int lane, FNfloat x, FNfloat y)
+        {
+            noise.PerlinSplit(x, PrimeX, xPrimed[lane], xd0[lane], xs[lane]);
+            noise.PerlinSplit(y, PrimeY, yPrimed[lane], yd0[lane], ys[lane]);
+        }
+
+        template <typename FNfloat>
+        void Set(const FastNoiseLite& noise, int lane, FNfloat x, FNfloat y, FNfloat z)
+        {
+            Set(noise, lane, x, y);
+            noise.PerlinSplit(z, PrimeZ, zPrimed[lane], zd0[lane], zs[lane]);
+        }
+    };
+
+    // SinglePerlin from already split coordinates, for the samples left over after the last full vector
+    float PerlinScalar2D(int x0, float xd0, float xs, int y0, float yd0, float ys) const
+    {
+        float xd1 = xd0 - 1;
+        float yd1 = yd0 - 1;
+        int x1 = x0 + PrimeX;
+        int y1 = y0 + PrimeY;
+
+        float xf0 = Lerp(GradCoord(mSeed, x0, y0, xd0, yd0), GradCoord(mSeed, x1, y0, xd1, yd0), xs);
+        float xf1 = Lerp(GradCoord(mSeed, x0, y1, xd0, yd1), GradCoord(mSeed, x1, y1, xd1, yd1), xs);
+
+        return Lerp(xf0, xf1, ys) * 1.4247691104677813f;
+    }
+
+    float PerlinScalar3D(int x0, float xd0, float xs, int y0, float yd0, float ys, int z0, float zd0, float zs) const
+    {
+        float xd1 = xd0 - 1;
+        float yd1 = yd0 - 1;
+        float zd1 = zd0 - 1;
+        int x1 = x0 + PrimeX;
+        int y1 = y0 + PrimeY;
+        int z1 = z0 + PrimeZ;
+
+        float xf00 = Lerp(GradCoord(mSeed, x0, y0, z0, xd0, yd0, zd0), GradCoord(mSeed, x1, y0, z0, xd1, yd0, zd0), xs);
+        float xf10 = Lerp(GradCoord(mSeed, x0, y1, z0, xd0, yd1, zd0), GradCoord(mSeed, x1, y1, z0, xd1, yd1, zd0), xs);
+        float xf01 = Lerp(GradCoord(mSeed, x0, y0, z1, xd0, yd0, zd1), GradCoord(mSeed, x1, y0, z1, xd1, yd0, zd1), xs);
+        float xf11 = Lerp(GradCoord(mSeed, x0, y1, z1, xd0, yd1, zd1), GradCoord(mSeed, x1, y1, z1, xd1, yd1, zd1), xs);
+
+        float yf0 = Lerp(xf00, xf10, ys);
+        float yf1 = Lerp(xf01, xf11, ys);
+
+        return Lerp(yf0, yf1, zs) * 0.964921414852142333984375f;
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 LerpAVX2(__m256 a, __m256 b, __m256 t)
+    {
+        return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i HashAVX2(__m256i seed, __m256i xPrimed, __m256i yPrimed)
+    {
+        __m256i hash = _mm256_xor_si256(_mm256_xor_si256(seed, xPrimed), yPrimed);
+        return _mm256_mullo_epi32(hash, _mm256_set1_epi32(0x27d4eb2d));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 GradCoordAVX2(__m256i seed, __m256i xPrimed, __m256i yPrimed, __m256 xd, __m256 yd)
+    {
+        __m256i hash = HashAVX2(seed, xPrimed, yPrimed);
+        hash = _mm256_xor_si256(hash, _mm256_srai_epi32(hash, 15));
+        hash = _mm256_and_si256(hash, _mm256_set1_epi32(127 << 1));
+
+        __m256 xg = _mm256_i32gather_ps(Lookup<float>::Gradients2D, hash, 4);
+        __m256 yg = _mm256_i32gather_ps(Lookup<float>::Gradients2D, _mm256_or_si256(hash, _mm256_set1_epi32(1)), 4);
+
+        return _mm256_add_ps(_mm256_mul_ps(xd, xg), _mm256_mul_ps(yd, yg));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 GradCoordAVX2(__m256i seed, __m256i xPrimed, __m256i yPrimed, __m256i zPrimed, __m256 xd, __m256 yd, __m256 zd)
+    {
+        __m256i hash = _mm256_mullo_epi32(_mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(seed, xPrimed), yPrimed), zPrimed),
+                                          _mm256_set1_epi32(0x27d4eb2d));
+        hash = _mm256_xor_si256(hash, _mm256_srai_epi32(hash, 15));
+        hash = _mm256_and_si256(hash, _mm256_set1_epi32(63 << 2));
+
+        __m256 xg = _mm256_i32gather_ps(Lookup<float>::Gradients3D, hash, 4);
+        __m256 yg = _mm256_i32gather_ps(Lookup<float>::Gradients3D, _mm256_or_si256(hash, _mm256_set1_epi32(1)), 4);
+        __m256 zg = _mm256_i32gather_ps(Lookup<float>::Gradients3D, _mm256_or_si256(hash, _mm256_set1_epi32(2)), 4);
+
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xd, xg), _mm256_mul_ps(yd, yg)), _mm256_mul_ps(zd, zg));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 PerlinAVX2(__m256i seed, __m256i x0, __m256 xd0, __m256 xs, __m256i y0, __m256 yd0, __m256 ys)
+    {
+        const __m256 one = _mm256_set1_ps(1);
+        __m256 xd1 = _mm256_sub_ps(xd0, one);
+        __m256 yd1 = _mm256_sub_ps(yd0, one);
+        __m256i x1 = _mm256_add_epi32(x0, _mm256_set1_epi32(PrimeX));
+        __m256i y1 = _mm256_add_epi32(y0, _mm256_set1_epi32(PrimeY));
+
+        __m256 xf0 = LerpAVX2(GradCoordAVX2(seed, x0, y0, xd0, yd0), GradCoordAVX2(seed, x1, y0, xd1, yd0), xs);
+        __m256 xf1 = LerpAVX2(GradCoordAVX2(seed, x0, y1, xd0, yd1), GradCoordAVX2(seed, x1, y1, xd1, yd1), xs);
+
+        return _mm256_mul_ps(LerpAVX2(xf0, xf1, ys), _mm256_set1_ps(1.4247691104677813f));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 PerlinAVX2(__m256i seed, __m256i x0, __m256 xd0, __m256 xs, __m256i y0, __m256 yd0, __m256 ys,
+                             __m256i z0, __m256 zd0, __m256 zs)
+    {
+        const __m256 one = _mm256_set1_ps(1);
+        __m256 xd1 = _mm256_sub_ps(xd0, one);
+        __m256 yd1 = _mm256_sub_ps(yd0, one);
+        __m256 zd1 = _mm256_sub_ps(zd0, one);
+        __m256i x1 = _mm256_add_epi32(x0, _mm256_set1_epi32(PrimeX));
+        __m256i y1 = _mm256_add_epi32(y0, _mm256_set1_epi32(PrimeY));
+        __m256i z1 = _mm256_add_epi32(z0, _mm256_set1_epi32(PrimeZ));
+
+        __m256 xf00 = LerpAVX2(GradCoordAVX2(seed, x0, y0, z0, xd0, yd0, zd0), GradCoordAVX2(seed, x1, y0, z0, xd1, yd0, zd0), xs);
+        __m256 xf10 = LerpAVX2(GradCoordAVX2(seed, x0, y1, z0, xd0, yd1, zd0), GradCoordAVX2(seed, x1, y1, z0, xd1, yd1, zd0), xs);
+        __m256 xf01 = LerpAVX2(GradCoordAVX2(seed, x0, y0, z1, xd0, yd0, zd1), GradCoordAVX2(seed, x1, y0, z1, xd1, yd0, zd1), xs);
+        __m256 xf11 = LerpAVX2(GradCoordAVX2(seed, x0, y1, z1, xd0, yd1, zd1), GradCoordAVX2(seed, x1, y1, z1, xd1, yd1, zd1), xs);
+
+        __m256 yf0 = LerpAVX2(xf00, xf10, ys);
+        __m256 yf1 = LerpAVX2(xf01, xf11, ys);
+
+        return _mm256_mul_ps(LerpAVX2(yf0, yf1, zs), _mm256_set1_ps(0.964921414852142333984375f));
+    }
+
+    __attribute__((target("avx2")))
+    void PerlinRow2D(float* out, const PerlinAxis& axisX, const PerlinAxis& axisY, int iy) const
+    {
+        const int size = (int)axisX.primed.size();
+        const __m256i seed = _mm256_set1_epi32(mSeed);
+        const __m256i y0 = _mm256_set1_epi32(axisY.primed[iy]);
+        const __m256 yd0 = _mm256_set1_ps(axisY.d0[iy]);
+        const __m256 ys = _mm256_set1_ps(axisY.s[iy]);
+        int ix = 0;
+        for (; ix + 8 <= size; ix += 8)
+        {
+            __m256i x0 = _mm256_loadu_si256((const __m256i*)(axisX.primed.data() + ix));
+            __m256 xd0 = _mm256_loadu_ps(axisX.d0.data() + ix);
+            __m256 xs = _mm256_loadu_ps(axisX.s.data() + ix);
+            _mm256_storeu_ps(out + ix, PerlinAVX2(seed, x0, xd0, xs, y0, yd0, ys));
+        }
+        for (; ix < size; ix++)
+        {
+            out[ix] = PerlinScalar2D(axisX.primed[ix], axisX.d0[ix], axisX.s[ix], axisY.primed[iy], axisY.d0[iy], axisY.s[iy]);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void PerlinRow3D(float* out, const PerlinAxis& axisX, const PerlinAxis& axisY, int iy, const PerlinAxis& axisZ, int iz) const
+    {
+        const int size = (int)axisX.primed.size();
+        const __m256i seed = _mm256_set1_epi32(mSeed);
+        const __m256i y0 = _mm256_set1_epi32(axisY.primed[iy]);
+        const __m256 yd0 = _mm256_set1_ps(axisY.d0[iy]);
+        const __m256 ys = _mm256_set1_ps(axisY.s[iy]);
+        const __m256i z0 = _mm256_set1_epi32(axisZ.primed[iz]);
+        const __m256 zd0 = _mm256_set1_ps(axisZ.d0[iz]);
+        const __m256 zs = _mm256_set1_ps(axisZ.s[iz]);
+        int ix = 0;
+        for (; ix + 8 <= size; ix += 8)
+        {
+            __m256i x0 = _mm256_loadu_si256((const __m256i*)(axisX.primed.data() + ix));
+            __m256 xd0 = _mm256_loadu_ps(axisX.d0.data() + ix);
+            __m256 xs = _mm256_loadu_ps(axisX.s.data() + ix);
+            _mm256_storeu_ps(out + ix, PerlinAVX2(seed, x0, xd0, xs, y0, yd0, ys, z0, zd0, zs));
+        }
+        for (; ix < size; ix++)
+        {
+            out[ix] = PerlinScalar3D(axisX.primed[ix], axisX.d0[ix], axisX.s[ix], axisY.primed[iy], axisY.d0[iy], axisY.s[iy],
+                                     axisZ.primed[iz], axisZ.d0[iz], axisZ.s[iz]);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void PerlinLanes2D(float* out, const PerlinLanes& lanes) const
+    {
+        _mm256_storeu_ps(out, PerlinAVX2(_mm256_set1_epi32(mSeed),
+                                         _mm256_loadu_si256((const __m256i*)lanes.xPrimed), _mm256_loadu_ps(lanes.xd0), _mm256_loadu_ps(lanes.xs),
+                                         _mm256_loadu_si256((const __m256i*)lanes.yPrimed), _mm256_loadu_ps(lanes.yd0), _mm256_loadu_ps(lanes.ys)));
+    }
+
+    __attribute__((target("avx2")))
+    void PerlinLanes3D(float* out, const PerlinLanes& lanes) const
+    {
+        _mm256_storeu_ps(out, PerlinAVX2(_mm256_set1_epi32(mSeed),
+                                         _mm256_loadu_si256((const __m256i*)lanes.xPrimed), _mm256_loadu_ps(lanes.xd0), _mm256_loadu_ps(lanes.xs),
+                                         _mm256_loadu_si256((const __m256i*)lanes.yPrimed), _mm256_loadu_ps(lanes.yd0), _mm256_loadu_ps(lanes.ys),
+                                         _mm256_loadu_si256((const __m256i*)lanes.zPrimed), _mm256_loadu_ps(lanes.zd0), _mm256_loadu_ps(lanes.zs)));
+    }
+
+    // Batched OpenSimplex2. Coordinates go through TransformNoiseCoordinate and are split into primed cell and float
+    // offset on the scalar side, in FNfloat like GetNoise does it; the vector kernels repeat the float and int part of
+    // SingleSimplex and SingleOpenSimplex2 with every branch turned into a select, so results are again identical.
+
+    bool CanBatchOpenSimplex2() const
+    {
+        return mNoiseType == NoiseType_OpenSimplex2 && mFractalType == FractalType_None;
+    }
+
+    // Eight positions, transformed and split
+    struct SimplexLanes
+    {
+        int i[8], j[8], k[8];
+        float x[8], y[8], z[8];
+
+        // 2D simplex cell: floor of the skewed position and the offset from it
+        template <typename FNfloat>
+        void Set(const FastNoiseLite& noise, int lane, FNfloat xs, FNfloat ys)
+        {
+            noise.TransformNoiseCoordinate(xs, ys);
+            int i0 = FastFloor(xs);
+            int j0 = FastFloor(ys);
+            x[lane] = (float)(xs - i0);
+            y[lane] = (float)(ys - j0);
+            i[lane] = i0 * PrimeX;
+            j[lane] = j0 * PrimeY;
+        }
+
+        // 3D cube cell: nearest lattice point of the rotated position and the offset from it
+        template <typename FNfloat>
+        void Set(const FastNoiseLite& noise, int lane, FNfloat xs, FNfloat ys, FNfloat zs)
+        {
+            noise.TransformNoiseCoordinate(xs, ys, zs);
+            int i0 = FastRound(xs);
+            int j0 = FastRound(ys);
+            int k0 = FastRound(zs);
+            x[lane] = (float)(xs - i0);
+            y[lane] = (float)(ys - j0);
+            z[lane] = (float)(zs - k0);
+            i[lane] = i0 * PrimeX;
+            j[lane] = j0 * PrimeY;
+            k[lane] = k0 * PrimeZ;
+        }
+    };
+
+    // position(index, x, y) gives the coordinates of sample index
+    template <typename FNfloat, typename Position>
+    void OpenSimplex2Batch2D(float* noiseOut, int count, Position position) const
+    {
+        SimplexLanes lanes;
+        FNfloat x, y;
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            for (int lane = 0; lane < 8; lane++)
+            {
+                position(i + lane, x, y);
+                lanes.Set(*this, lane, x, y);
+            }
+            OpenSimplex2Lanes2D(noiseOut + i, lanes);
+        }
+        for (; i < count; i++)
+        {
+            position(i, x, y);
+            noiseOut[i] = GetNoise(x, y);
+        }
+    }
+
+    template <typename FNfloat, typename Position>
+    void OpenSimplex2Batch3D(float* noiseOut, int count, Position position) const
+    {
+        SimplexLanes lanes;
+        FNfloat x, y, z;
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            for (int lane = 0; lane < 8; lane++)
+            {
+                position(i + lane, x, y, z);
+                lanes.Set(*this, lane, x, y, z);
+            }
+            OpenSimplex2Lanes3D(noiseOut + i, lanes);
+        }
+        for (; i < count; i++)
+        {
+            position(i, x, y, z);
+            noiseOut[i] = GetNoise(x, y, z);
+        }
+    }
+
+    // a where mask is set, +0 elsewhere
+    __attribute__((target("avx2")))
+    static __m256 MaskAVX2(__m256 mask, __m256 a)
+    {
+        return _mm256_and_ps(mask, a);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256 Pow4AVX2(__m256 a)
+    {
+        __m256 a2 = _mm256_mul_ps(a, a);
+        return _mm256_mul_ps(a2, a2);
+    }
+
+    // SingleSimplex
+    __attribute__((target("avx2")))
+    void OpenSimplex2Lanes2D(float* out, const SimplexLanes& lanes) const
+    {
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        const float G2 = (3 - SQRT3) / 6;
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256i seed = _mm256_set1_epi32(mSeed);
+        const __m256i primeX = _mm256_set1_epi32(PrimeX);
+        const __m256i primeY = _mm256_set1_epi32(PrimeY);
+
+        __m256i i = _mm256_loadu_si256((const __m256i*)lanes.i);
+        __m256i j = _mm256_loadu_si256((const __m256i*)lanes.j);
+        __m256 xi = _mm256_loadu_ps(lanes.x);
+        __m256 yi = _mm256_loadu_ps(lanes.y);
+
+        __m256 t = _mm256_mul_ps(_mm256_add_ps(xi, yi), _mm256_set1_ps(G2));
+        __m256 x0 = _mm256_sub_ps(xi, t);
+        __m256 y0 = _mm256_sub_ps(yi, t);
+
+        __m256 a = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x0, x0)), _mm256_mul_ps(y0, y0));
+        __m256 n0 = MaskAVX2(_mm256_cmp_ps(a, zero, _CMP_GT_OQ), _mm256_mul_ps(Pow4AVX2(a), GradCoordAVX2(seed, i, j, x0, y0)));
+
+        __m256 c = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps((float)(2 * (1 - 2 * G2) * (1 / G2 - 2))), t),
+                                 _mm256_add_ps(_mm256_set1_ps((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2))), a));
+        __m256 x2 = _mm256_add_ps(x0, _mm256_set1_ps(2 * (float)G2 - 1));
+        __m256 y2 = _mm256_add_ps(y0, _mm256_set1_ps(2 * (float)G2 - 1));
+        __m256 n2 = MaskAVX2(_mm256_cmp_ps(c, zero, _CMP_GT_OQ),
+                             _mm256_mul_ps(Pow4AVX2(c), GradCoordAVX2(seed, _mm256_add_epi32(i, primeX), _mm256_add_epi32(j, primeY), x2, y2)));
+
+        // y0 > x0 takes the corner above, otherwise the one to the right
+        __m256 upper = _mm256_cmp_ps(y0, x0, _CMP_GT_OQ);
+        __m256i upperInt = _mm256_castps_si256(upper);
+        __m256 x1 = _mm256_add_ps(x0, _mm256_blendv_ps(_mm256_set1_ps((float)G2 - 1), _mm256_set1_ps((float)G2), upper));
+        __m256 y1 = _mm256_add_ps(y0, _mm256_blendv_ps(_mm256_set1_ps((float)G2), _mm256_set1_ps((float)G2 - 1), upper));
+        __m256i i1 = _mm256_add_epi32(i, _mm256_andnot_si256(upperInt, primeX));
+        __m256i j1 = _mm256_add_epi32(j, _mm256_and_si256(upperInt, primeY));
+        __m256 b = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x1, x1)), _mm256_mul_ps(y1, y1));
+        __m256 n1 = MaskAVX2(_mm256_cmp_ps(b, zero, _CMP_GT_OQ), _mm256_mul_ps(Pow4AVX2(b), GradCoordAVX2(seed, i1, j1, x1, y1)));
+
+        _mm256_storeu_ps(out, _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(n0, n1), n2), _mm256_set1_ps(99.83685446303647f)));
+    }
+
+    // SingleOpenSimplex2, both lattices unrolled
+    __attribute__((target("avx2")))
+    void OpenSimplex2Lanes3D(float* out, const SimplexLanes& lanes) const
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 signBit = _mm256_set1_ps(-0.0f);
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i primeX = _mm256_set1_epi32(PrimeX);
+        const __m256i primeY = _mm256_set1_epi32(PrimeY);
+        const __m256i primeZ = _mm256_set1_epi32(PrimeZ);
+        __m256i seed = _mm256_set1_epi32(mSeed);
+
+        __m256i i = _mm256_loadu_si256((const __m256i*)lanes.i);
+        __m256i j = _mm256_loadu_si256((const __m256i*)lanes.j);
+        __m256i k = _mm256_loadu_si256((const __m256i*)lanes.k);
+        __m256 x0 = _mm256_loadu_ps(lanes.x);
+        __m256 y0 = _mm256_loadu_ps(lanes.y);
+        __m256 z0 = _mm256_loadu_ps(lanes.z);
+
+        const __m256 minusOne = _mm256_set1_ps(-1.0f);
+        __m256i xNSign = _mm256_or_si256(_mm256_cvttps_epi32(_mm256_sub_ps(minusOne, x0)), one);
+        __m256i yNSign = _mm256_or_si256(_mm256_cvttps_epi32(_mm256_sub_ps(minusOne, y0)), one);
+        __m256i zNSign = _mm256_or_si256(_mm256_cvttps_epi32(_mm256_sub_ps(minusOne, z0)), one);
+
+        __m256 ax0 = _mm256_mul_ps(_mm256_cvtepi32_ps(xNSign), _mm256_xor_ps(x0, signBit));
+        __m256 ay0 = _mm256_mul_ps(_mm256_cvtepi32_ps(yNSign), _mm256_xor_ps(y0, signBit));
+        __m256 az0 = _mm256_mul_ps(_mm256_cvtepi32_ps(zNSign), _mm256_xor_ps(z0, signBit));
+
+        __m256 value = zero;
+        __m256 a = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.6f), _mm256_mul_ps(x0, x0)),
+                                 _mm256_add_ps(_mm256_mul_ps(y0, y0), _mm256_mul_ps(z0, z0)));
+
+        for (int l = 0; l < 2; l++)
+        {
+            value = _mm256_add_ps(value, MaskAVX2(_mm256_cmp_ps(a, zero, _CMP_GT_OQ),
+                                                  _mm256_mul_ps(Pow4AVX2(a), GradCoordAVX2(seed, i, j, k, x0, y0, z0))));
+
+            // The second corner is one step along the axis the offset is largest on, x before y before z
+            __m256 alongX = _mm256_and_ps(_mm256_cmp_ps(ax0, ay0, _CMP_GE_OQ), _mm256_cmp_ps(ax0, az0, _CMP_GE_OQ));
+            __m256 alongY = _mm256_andnot_ps(alongX, _mm256_and_ps(_mm256_cmp_ps(ay0, ax0, _CMP_GT_OQ), _mm256_cmp_ps(ay0, az0, _CMP_GE_OQ)));
+            __m256 alongZ = _mm256_andnot_ps(_mm256_or_ps(alongX, alongY), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+
+            __m256 b = _mm256_add_ps(a, _mm256_set1_ps(1));
+            __m256 xSign = _mm256_cvtepi32_ps(xNSign);
+            __m256 ySign = _mm256_cvtepi32_ps(yNSign);
+            __m256 zSign = _mm256_cvtepi32_ps(zNSign);
+            __m256 x1 = _mm256_blendv_ps(x0, _mm256_add_ps(x0, xSign), alongX);
+            __m256 y1 = _mm256_blendv_ps(y0, _mm256_add_ps(y0, ySign), alongY);
+            __m256 z1 = _mm256_blendv_ps(z0, _mm256_add_ps(z0, zSign), alongZ);
+            __m256 step = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_mul_ps(_mm256_add_ps(zSign, zSign), z1),
+                                                            _mm256_mul_ps(_mm256_add_ps(ySign, ySign), y1), alongY),
+                                           _mm256_mul_ps(_mm256_add_ps(xSign, xSign), x1), alongX);
+            b = _mm256_sub_ps(b, step);
+            __m256i i1 = _mm256_sub_epi32(i, _mm256_and_si256(_mm256_castps_si256(alongX), _mm256_mullo_epi32(xNSign, primeX)));
+            __m256i j1 = _mm256_sub_epi32(j, _mm256_and_si256(_mm256_castps_si256(alongY), _mm256_mullo_epi32(yNSign, primeY)));
+            __m256i k1 = _mm256_sub_epi32(k, _mm256_and_si256(_mm256_castps_si256(alongZ), _mm256_mullo_epi32(zNSign, primeZ)));
+
+            value = _mm256_add_ps(value, MaskAVX2(_mm256_cmp_ps(b, zero, _CMP_GT_OQ),
+                                                  _mm256_mul_ps(Pow4AVX2(b), GradCoordAVX2(seed, i1, j1, k1, x1, y1, z1))));
+
+            if (l == 1) break;
+
+            ax0 = _mm256_sub_ps(half, ax0);
+            ay0 = _mm256_sub_ps(half, ay0);
+            az0 = _mm256_sub_ps(half, az0);
+
+            x0 = _mm256_mul_ps(xSign, ax0);
+            y0 = _mm256_mul_ps(ySign, ay0);
+            z0 = _mm256_mul_ps(zSign, az0);
+
+            a = _mm256_add_ps(a, _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.75f), ax0), _mm256_add_ps(ay0, az0)));
+
+            i = _mm256_add_epi32(i, _mm256_and_si256(_mm256_srai_epi32(xNSign, 1), primeX));
+            j = _mm256_add_epi32(j, _mm256_and_si256(_mm256_srai_epi32(yNSign, 1), primeY));
+            k = _mm256_add_epi32(k, _mm256_and_si256(_mm256_srai_epi32(zNSign, 1), primeZ));
+
+            xNSign = _mm256_sub_epi32(_mm256_setzero_si256(), xNSign);
+            yNSign = _mm256_sub_epi32(_mm256_setzero_si256(), yNSign);
+            zNSign = _mm256_sub_epi32(_mm256_setzero_si256(), zNSign);
+
+            seed = _mm256_xor_si256(seed, _mm256_set1_epi32(-1));
+        }
+
+        _mm256_storeu_ps(out, _mm256_mul_ps(value, _mm256_set1_ps(32.69428253173828125f)));
+    }
+#endif
 };
 
 template <>
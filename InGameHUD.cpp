@@ -71,9 +71,10 @@ void InGameHUD::SetupCrosshair() {
 
 
 void InGameHUD::RenderCrosshair() {
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderState& state = renderState();
+    state.disable(GL_DEPTH_TEST);
+    state.enable(GL_BLEND);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     hudShader.use();
 
@@ -81,19 +82,14 @@ void InGameHUD::RenderCrosshair() {
     hudShader.setMat4("projection", projection);
 
 
-    glActiveTexture(GL_TEXTURE2);  // Use GL_TEXTURE2 to avoid conflicts
-    glBindTexture(GL_TEXTURE_2D, textureAtlas);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    state.bindTexture(2, GL_TEXTURE_2D, textureAtlas);  // Use GL_TEXTURE2 to avoid conflicts
+    state.bindSampler(2, state.sampler(ATLAS_SAMPLER));
     hudShader.setInt("texture1", 2);  // Set uniform to slot 2
 
-    glBindVertexArray(crosshairVAO);
+    state.bindVertexArray(crosshairVAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 
-    glEnable(GL_DEPTH_TEST);
+    state.enable(GL_DEPTH_TEST);
 }
 
 
@@ -109,6 +105,107 @@ void InGameHUD::RenderHUD(glm::vec3 playerPosition, glm::vec2 chunkPosition) {
                  std::to_string(playerPosition.z)).c_str());
     ImGui::Text(("Chunk: " + std::to_string(static_cast<int>(chunkPosition.x)) + " " +
                  std::to_string(static_cast<int>(chunkPosition.y))).c_str());
+
+    ImGui::Checkbox("Greedy meshing", &greedyMeshing);
+    if (ImGui::Button("Benchmark meshing")) {
+        meshBenchmarkRequested = true;
+    }
+    for (const MeshBenchmarkResult& result : meshBenchmarkResults) {
+        ImGui::Text("%s: %zu faces, %zu KiB, %.2f ms", result.mode.c_str(), result.faces, result.bytes / 1024, result.milliseconds);
+    }
+    if (ImGui::Button("Compare cave sampling")) {
+        caveComparisonRequested = true;
+    }
+    if (caveComparison.chunks > 0) {
+        ImGui::Text("Lattice: %zu samples, %.2f ms / full: %zu samples, %.2f ms (%.1fx faster)", caveComparison.coarseSamples,
+                    caveComparison.coarseMilliseconds, caveComparison.fullSamples, caveComparison.fullMilliseconds,
+                    caveComparison.fullMilliseconds / caveComparison.coarseMilliseconds);
+        ImGui::Text("%zu chunks, %zu of %zu blocks differ (%.2f%%)", caveComparison.chunks, caveComparison.differingBlocks,
+                    caveComparison.blocks, caveComparison.differingBlocks * 100.0 / caveComparison.blocks);
+    }
+
+    ImGui::Text("Vertex heap: %zu / %zu KiB in %zu slices", vertexHeapStats.used / 1024, vertexHeapStats.capacity / 1024,
+                vertexHeapStats.allocations);
+    ImGui::Text("Free blocks: %zu, largest %zu KiB, fragmentation %.1f%%, grown %zu times", vertexHeapStats.freeBlocks,
+                vertexHeapStats.largestFreeBlock / 1024, vertexHeapStats.fragmentation() * 100.0, vertexHeapStats.grows);
+
+    ImGui::Text("Drawn: %zu / %zu chunks, %zu / %zu sections in %zu draws", cullingStats.visibleChunks, cullingStats.chunks,
+                cullingStats.visibleSections, cullingStats.sections, cullingStats.draws);
+    ImGui::Text("Hidden behind blocks: %zu sections", cullingStats.occludedSections);
+
+    UniformStats uniforms = uniformStats;
+    uniforms += hudShader.uniformStats();
+    ImGui::Text("Uniforms: %llu sent, %llu unchanged and skipped", static_cast<unsigned long long>(uniforms.uploads),
+                static_cast<unsigned long long>(uniforms.unchanged));
+    ImGui::Text("GL state calls: %llu issued, %llu elided last frame", static_cast<unsigned long long>(renderStateStats.issued),
+                static_cast<unsigned long long>(renderStateStats.elided));
+
+    ImGui::Text("Jobs: %zu workers, queued %zu high / %zu normal / %zu low", jobSystemStats.workers, jobSystemStats.queued[0],
+                jobSystemStats.queued[1], jobSystemStats.queued[2]);
+    ImGui::Text("Executed %llu, stolen %llu", static_cast<unsigned long long>(jobSystemStats.executed),
+                static_cast<unsigned long long>(jobSystemStats.steals));
+
+    for (int stage = static_cast<int>(ChunkStage::Terrain); stage < CHUNK_STAGE_COUNT; ++stage) {
+        const ChunkStageStats& stats = chunkStageStats[stage];
+        ImGui::Text("%s: %zu done, %zu in flight, %zu cancelled, run %.2f ms, latency %.2f ms (max %.2f)",
+                    chunkStageName(static_cast<ChunkStage>(stage)), stats.completed, stats.inFlight, stats.cancelled,
+                    stats.averageRunMilliseconds(), stats.averageLatencyMilliseconds(), stats.maxLatencyMilliseconds);
+    }
+    ImGui::Text("First geometry: %.0f ms after spawn, chunks in view waited %.0f ms (last), %.0f ms (average), %.0f ms (max)",
+                firstGeometryStats.spawnMilliseconds, firstGeometryStats.lastMilliseconds, firstGeometryStats.averageMilliseconds(),
+                firstGeometryStats.maxMilliseconds);
+    ImGui::Text("Prefetch: moving %.1f blocks/s, heading for chunk %d %d, keeping chunks around %d %d", glm::length(cameraVelocity),
+                chunkFocus.predicted.first, chunkFocus.predicted.second, chunkFocus.anchor.first, chunkFocus.anchor.second);
+    ImGui::Checkbox("Record camera path", &recordingCameraPath);
+    ImGui::SameLine();
+    ImGui::Text("%.1f s recorded", cameraPathSeconds);
+    if (ImGui::Button("Benchmark prefetch")) {
+        prefetchBenchmarkRequested = true;
+    }
+    if (prefetchBenchmarkRequested) {
+        ImGui::SameLine();
+        ImGui::Text("Running...");
+    }
+    for (const PrefetchBenchmarkResult& result : prefetchBenchmarkResults) {
+        ImGui::Text("%s: %.1f holes/s over %.1f s (max %zu in a frame), %zu generated, %zu unloaded, %zu stages cancelled",
+                    result.policy.c_str(), result.holesPerSecond, result.seconds, result.maxHoles, result.generated, result.unloads,
+                    result.cancelled);
+    }
+    ImGui::Text("Chunk map: %zu chunks, %zu unloaded and still in use, version %llu", chunkMapStats.entries, chunkMapStats.retired,
+                static_cast<unsigned long long>(chunkMapStats.version));
+    if (ImGui::Button("Benchmark chunk index")) {
+        chunkIndexBenchmarkRequested = true;
+    }
+    for (const ChunkIndexBenchmarkResult& result : chunkIndexBenchmarkResults) {
+        ImGui::Text("%zu chunks, ns per op, std::map / index: insert %.1f / %.1f, find %.1f / %.1f, erase %.1f / %.1f", result.chunks,
+                    result.mapInsertNanoseconds, result.indexInsertNanoseconds, result.mapFindNanoseconds, result.indexFindNanoseconds,
+                    result.mapEraseNanoseconds, result.indexEraseNanoseconds);
+    }
+    ImGui::Text("Surface cache: %zu / %zu tiles, hit rate %.1f%%, %llu evicted", surfaceCacheStats.tiles, surfaceCacheStats.capacity,
+                surfaceCacheStats.hitRate() * 100.0, static_cast<unsigned long long>(surfaceCacheStats.evictions));
+
+    ImGui::Text("World store: %zu regions, %llu loaded, %llu saved (%llu KiB), %zu queued, %llu compactions", worldStoreStats.regions,
+                static_cast<unsigned long long>(worldStoreStats.loads), static_cast<unsigned long long>(worldStoreStats.saves),
+                static_cast<unsigned long long>(worldStoreStats.bytesWritten / 1024), worldStoreStats.pending,
+                static_cast<unsigned long long>(worldStoreStats.compactions));
+    if (ImGui::Button("Benchmark storage")) {
+        storageBenchmarkRequested = true;
+    }
+    if (storageBenchmark.chunks > 0) {
+        ImGui::Text("%zu chunks, %.1f KiB each: load %.0f chunks/s, generate %.0f chunks/s", storageBenchmark.chunks,
+                    storageBenchmark.bytes / 1024.0 / storageBenchmark.chunks, storageBenchmark.chunks * 1000.0 / storageBenchmark.loadMilliseconds,
+                    storageBenchmark.chunks * 1000.0 / storageBenchmark.generateMilliseconds);
+    }
+    if (ImGui::Button("Benchmark section storage")) {
+        sectionStorageBenchmarkRequested = true;
+    }
+    if (sectionStorageBenchmark.sections > 0) {
+        const SectionStorageBenchmarkResult& result = sectionStorageBenchmark;
+        ImGui::Text("%zu sections, flat / palette: %.1f / %.1f KiB each, ns per block: get %.2f / %.2f, set %.2f / %.2f, unpack %.2f / %.2f",
+                    result.sections, result.flatBytes / 1024.0 / result.sections, result.paletteBytes / 1024.0 / result.sections,
+                    result.flatGetNanoseconds, result.paletteGetNanoseconds, result.flatSetNanoseconds, result.paletteSetNanoseconds,
+                    result.flatUnpackNanoseconds, result.paletteUnpackNanoseconds);
+    }
     ImGui::End();
 
     RenderCrosshair();
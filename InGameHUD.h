@@ -2,7 +2,80 @@
 #define INGAMEHUD_H
 
 #include "shader.h"
+#include <array>
 #include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include "chunk_prefetch.h"
+#include "chunk_stage.h"
+#include "frustum_culling.h"
+#include "job_system.h"
+#include "snapshot_map.h"
+#include "surface_cache.h"
+#include "world_store.h"
+#include "vertex_heap.h"
+
+// Result of meshing the loaded chunks in one meshing mode
+struct MeshBenchmarkResult {
+    std::string mode;
+    std::size_t faces = 0;
+    std::size_t bytes = 0;
+    double milliseconds = 0.0;
+};
+
+// Terrain of the loaded chunks generated once on the cave lattice from the settings and once at full resolution
+struct CaveSamplingComparison {
+    std::size_t chunks = 0;
+    std::size_t coarseSamples = 0;   // 3D noise samples
+    std::size_t fullSamples = 0;
+    double coarseMilliseconds = 0.0;
+    double fullMilliseconds = 0.0;
+    std::size_t differingBlocks = 0; // Blocks that come out different between the two
+    std::size_t blocks = 0;
+};
+
+// The same chunks loaded from the world store and generated from scratch
+struct StorageBenchmarkResult {
+    std::size_t chunks = 0;
+    std::size_t bytes = 0; // Saved size of all of them
+    double loadMilliseconds = 0.0;
+    double generateMilliseconds = 0.0;
+};
+
+// The non-uniform sections of the loaded chunks kept in the flat layout and in the palette layout, times per block
+struct SectionStorageBenchmarkResult {
+    std::size_t sections = 0;
+    std::size_t flatBytes = 0;
+    std::size_t paletteBytes = 0;
+    double flatGetNanoseconds = 0.0;
+    double paletteGetNanoseconds = 0.0;
+    double flatSetNanoseconds = 0.0; // Writing every block of a fresh section
+    double paletteSetNanoseconds = 0.0;
+    double flatUnpackNanoseconds = 0.0;
+    double paletteUnpackNanoseconds = 0.0;
+};
+
+// Chunk position lookups in the chunk map's ChunkIndex against the std::map it replaced, per operation
+struct ChunkIndexBenchmarkResult {
+    std::size_t chunks = 0;
+    double mapInsertNanoseconds = 0.0;
+    double indexInsertNanoseconds = 0.0;
+    double mapFindNanoseconds = 0.0; // A chunk and its four neighbours, the pipeline's lookup pattern
+    double indexFindNanoseconds = 0.0;
+    double mapEraseNanoseconds = 0.0;
+    double indexEraseNanoseconds = 0.0;
+};
+
+// One replay of a camera path with one chunk loading policy
+struct PrefetchBenchmarkResult {
+    std::string policy;
+    double seconds = 0.0;
+    double holesPerSecond = 0.0; // Chunks in view and render distance without geometry, summed over 60 frames a second
+    std::size_t maxHoles = 0;    // In a single frame
+    std::size_t generated = 0;   // Chunks that went through Terrain
+    std::size_t unloads = 0;
+    std::size_t cancelled = 0;   // Stages dropped before they ran
+};
 
 class InGameHUD {
 public:
@@ -11,6 +84,35 @@ public:
 
     void RenderHUD(glm::vec3 playerPosition, glm::vec2 chunkPosition);
 
+    // Debug window controls, read and filled in by the main loop
+    bool greedyMeshing = true;           // Meshing mode used for chunks meshed from now on
+    bool meshBenchmarkRequested = false; // Set by the benchmark button, cleared once the caller ran it
+    std::vector<MeshBenchmarkResult> meshBenchmarkResults;
+    bool caveComparisonRequested = false; // Same as meshBenchmarkRequested for the cave sampling comparison
+    CaveSamplingComparison caveComparison;
+    bool storageBenchmarkRequested = false; // Same for the storage benchmark
+    StorageBenchmarkResult storageBenchmark;
+    bool sectionStorageBenchmarkRequested = false; // Same for the section storage benchmark
+    SectionStorageBenchmarkResult sectionStorageBenchmark;
+    bool chunkIndexBenchmarkRequested = false; // Same for the chunk index benchmark
+    std::vector<ChunkIndexBenchmarkResult> chunkIndexBenchmarkResults;
+    bool recordingCameraPath = false;     // The main loop records the camera while set, for the prefetch benchmark
+    float cameraPathSeconds = 0.0f;       // Length of the recorded path
+    bool prefetchBenchmarkRequested = false; // Same as meshBenchmarkRequested, cleared once the benchmark thread is done
+    std::vector<PrefetchBenchmarkResult> prefetchBenchmarkResults;
+    VertexHeapStats vertexHeapStats;     // Shown as is, refreshed by the caller every frame
+    JobSystemStats jobSystemStats;       // Same
+    std::array<ChunkStageStats, CHUNK_STAGE_COUNT> chunkStageStats{}; // Same
+    FirstGeometryStats firstGeometryStats; // Same
+    ChunkFocus chunkFocus;                // Same
+    glm::vec3 cameraVelocity{0.0f};       // Same, as ChunkPrefetch sees it
+    SurfaceCacheStats surfaceCacheStats;  // Same
+    WorldStoreStats worldStoreStats;      // Same
+    SnapshotMapStats chunkMapStats;       // Same
+    CullingStats cullingStats;            // Filled in by the draw loop
+    UniformStats uniformStats;            // Of the world's shaders, the HUD adds its own
+    RenderStateStats renderStateStats;    // Of the previous frame, HUD included
+
 private:
     int screenWidth, screenHeight;
     GLuint crosshairVAO{}, crosshairVBO{}, crosshairEBO{};
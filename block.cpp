@@ -1,6 +1,15 @@
+#ifndef BLOCK_CPP
+#define BLOCK_CPP
+
+#include <array>
+#include <cstdint>
+#include <iterator>
 #include <string_view>
 #include <glm/vec2.hpp>
 
+// Numeric block id stored per voxel, index into BLOCK_REGISTRY
+using BlockID = std::uint16_t;
+
 class Block {
 public:
     std::string_view name;
@@ -128,3 +137,129 @@ struct Blocks {
         true, true
     };
 };
+
+// Every block gets a dense numeric id (its position in this table), chunks only store those ids
+inline constexpr const Block* BLOCK_REGISTRY[] = {
+    &Blocks::AIR,
+    &Blocks::DIRT,
+    &Blocks::STONE,
+    &Blocks::GRASS_BLOCK,
+    &Blocks::OAK_PLANKS,
+    &Blocks::OAK_LOG,
+    &Blocks::OAK_LEAVES,
+    &Blocks::SAND,
+    &Blocks::CACTUS,
+    &Blocks::WATER,
+};
+constexpr std::size_t BLOCK_COUNT = std::size(BLOCK_REGISTRY);
+
+constexpr BlockID blockId(const Block& block) {
+    for (std::size_t i = 0; i < BLOCK_COUNT; ++i) {
+        if (*BLOCK_REGISTRY[i] == block) {
+            return static_cast<BlockID>(i);
+        }
+    }
+    return 0; // Unknown blocks fall back to air
+}
+
+constexpr const Block& blockFromId(BlockID id) {
+    return *BLOCK_REGISTRY[id];
+}
+
+struct BlockIds {
+    static constexpr BlockID AIR = blockId(Blocks::AIR);
+    static constexpr BlockID DIRT = blockId(Blocks::DIRT);
+    static constexpr BlockID STONE = blockId(Blocks::STONE);
+    static constexpr BlockID GRASS_BLOCK = blockId(Blocks::GRASS_BLOCK);
+    static constexpr BlockID OAK_PLANKS = blockId(Blocks::OAK_PLANKS);
+    static constexpr BlockID OAK_LOG = blockId(Blocks::OAK_LOG);
+    static constexpr BlockID OAK_LEAVES = blockId(Blocks::OAK_LEAVES);
+    static constexpr BlockID SAND = blockId(Blocks::SAND);
+    static constexpr BlockID CACTUS = blockId(Blocks::CACTUS);
+    static constexpr BlockID WATER = blockId(Blocks::WATER);
+};
+
+static_assert(BlockIds::AIR == 0, "Air must be id 0 so zero-filled storage is empty");
+
+// Compile-time property tables, indexed by BlockID. One bit per block, so a property test is a shift and a mask.
+using BlockMask = std::uint64_t;
+static_assert(BLOCK_COUNT <= 64, "BlockMask only has room for 64 block ids");
+
+constexpr BlockMask TRANSPARENT_BLOCKS = [] {
+    BlockMask mask = 0;
+    for (std::size_t i = 0; i < BLOCK_COUNT; ++i) {
+        if (BLOCK_REGISTRY[i]->isTransparent) mask |= BlockMask{1} << i;
+    }
+    return mask;
+}();
+
+constexpr BlockMask LIQUID_BLOCKS = [] {
+    BlockMask mask = 0;
+    for (std::size_t i = 0; i < BLOCK_COUNT; ++i) {
+        if (BLOCK_REGISTRY[i]->isLiquid) mask |= BlockMask{1} << i;
+    }
+    return mask;
+}();
+
+constexpr bool isTransparent(BlockID id) {
+    return (TRANSPARENT_BLOCKS >> id) & 1;
+}
+
+constexpr bool isLiquid(BlockID id) {
+    return (LIQUID_BLOCKS >> id) & 1;
+}
+
+// The terrain atlas is a 16x16 grid of tiles, offsets are stored as (column, -row)
+constexpr int ATLAS_TILES_PER_ROW = 16;
+
+constexpr std::uint8_t atlasTile(glm::vec2 offset) {
+    return static_cast<std::uint8_t>(static_cast<int>(offset.x) - static_cast<int>(offset.y) * ATLAS_TILES_PER_ROW);
+}
+
+constexpr glm::vec2 atlasOffset(std::uint8_t tile) {
+    return {static_cast<float>(tile % ATLAS_TILES_PER_ROW), -static_cast<float>(tile / ATLAS_TILES_PER_ROW)};
+}
+
+using FaceTiles = std::array<std::array<std::uint8_t, 6>, BLOCK_COUNT>;
+
+// Atlas tile of every face (same face order as Block::textureOffsets) for every block
+constexpr FaceTiles FACE_TILES = [] {
+    FaceTiles tiles{};
+    for (std::size_t i = 0; i < BLOCK_COUNT; ++i) {
+        for (int face = 0; face < 6; ++face) {
+            tiles[i][face] = atlasTile(BLOCK_REGISTRY[i]->textureOffsets[face]);
+        }
+    }
+    return tiles;
+}();
+
+// Atlas tile of the tinted overlay drawn on top of every face
+constexpr FaceTiles FACE_OVERLAY_TILES = [] {
+    FaceTiles tiles{};
+    for (std::size_t i = 0; i < BLOCK_COUNT; ++i) {
+        for (int face = 0; face < 6; ++face) {
+            tiles[i][face] = atlasTile(BLOCK_REGISTRY[i]->textureOffsetOverlays[face]);
+        }
+    }
+    return tiles;
+}();
+
+static_assert(isTransparent(BlockIds::AIR) && isTransparent(BlockIds::WATER) && !isTransparent(BlockIds::STONE));
+static_assert(isLiquid(BlockIds::WATER) && !isLiquid(BlockIds::AIR));
+static_assert(atlasOffset(FACE_TILES[BlockIds::GRASS_BLOCK][5]) == Blocks::GRASS_BLOCK.textureOffsets[5]);
+
+// A property of 64 consecutive voxels packed into one word: bit i is set if ids[i] is in the property mask
+inline std::uint64_t blockMask64(const BlockID* ids, BlockMask property) {
+    std::uint64_t mask = 0;
+    for (int i = 0; i < 64; ++i) {
+        mask |= ((property >> ids[i]) & 1) << i;
+    }
+    return mask;
+}
+
+// Transparency of 64 consecutive voxels packed into one word, bit i belongs to ids[i]
+inline BlockMask transparencyMask64(const BlockID* ids) {
+    return blockMask64(ids, TRANSPARENT_BLOCKS);
+}
+
+#endif // BLOCK_CPP
@@ -0,0 +1,60 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct CameraKeyframe {
+    float seconds = 0.0f; // From the start of the path
+    glm::vec3 position{0.0f};
+    glm::vec3 front{0.0f, 0.0f, -1.0f};
+};
+
+// A camera flight that can be replayed frame by frame, recorded from the player or laid out by hand. Positions and
+// view directions are interpolated linearly between keyframes.
+class CameraPath {
+public:
+    // Keyframes have to come in order of time
+    void add(float seconds, glm::vec3 position, glm::vec3 front) {
+        keyframes.push_back({seconds, position, front});
+    }
+
+    void clear() {
+        keyframes.clear();
+    }
+
+    bool empty() const {
+        return keyframes.empty();
+    }
+
+    std::size_t size() const {
+        return keyframes.size();
+    }
+
+    float duration() const {
+        return keyframes.empty() ? 0.0f : keyframes.back().seconds;
+    }
+
+    // Where the camera is at seconds, held at the first or last keyframe outside the path. The path must not be empty.
+    // Halfway between two opposite view directions there is no direction to normalize, the earlier one is kept there.
+    CameraKeyframe sample(float seconds) const {
+        auto after = std::upper_bound(keyframes.begin(), keyframes.end(), seconds,
+                                      [](float t, const CameraKeyframe& keyframe) { return t < keyframe.seconds; });
+        if (after == keyframes.begin()) return keyframes.front();
+        if (after == keyframes.end()) return keyframes.back();
+        const CameraKeyframe& before = *(after - 1);
+        const float t = (seconds - before.seconds) / (after->seconds - before.seconds);
+        const glm::vec3 front = glm::mix(before.front, after->front, t);
+        return {seconds, glm::mix(before.position, after->position, t),
+                glm::dot(front, front) > MIN_FRONT_LENGTH * MIN_FRONT_LENGTH ? glm::normalize(front) : before.front};
+    }
+
+private:
+    static constexpr float MIN_FRONT_LENGTH = 1e-4f;
+
+    std::vector<CameraKeyframe> keyframes;
+};
+
+#endif // CAMERA_PATH_H
@@ -1,119 +1,227 @@
 #include "chunk.h"
+#include "face_culling.h"
 #include "settings.cpp"
+#include "surface_cache.h"
+#include "worldgen_random.h"
 #include <iostream>
 
 Chunk::Chunk(int chunkX, int chunkZ) : chunkX(chunkX), chunkZ(chunkZ){
-    blocks.resize(
-        CHUNK_SIZE_X,
-        std::vector(
-            CHUNK_SIZE_Y,
-            std::vector(CHUNK_SIZE_Z, Blocks::AIR)
-        )
-    );
-    generateChunk(chunkX, chunkZ);
 }
 
 bool Chunk::operator==(const Chunk& other) const {
     return this->chunkX == other.chunkX && this->chunkZ == other.chunkZ;
 }
 
+const Block& Chunk::getBlock(int x, int y, int z) const {
+    return blockFromId(getBlockId(x, y, z));
+}
+
+BlockID Chunk::getBlockId(int x, int y, int z) const {
+    return sections[y / SECTION_SIZE].get(x, y % SECTION_SIZE, z);
+}
+
+void Chunk::setBlock(int x, int y, int z, BlockID id) {
+    sections[y / SECTION_SIZE].set(x, y % SECTION_SIZE, z, id);
+}
+
+const ChunkSection& Chunk::getSection(int sectionY) const {
+    return sections[sectionY];
+}
+
+static_assert(ChunkSection::Storage::LAYOUT == ChunkLayout::XZY, "computeSectionConnectivity() expects y fastest");
+
+SectionConnectivity Chunk::sectionConnectivity(int sectionY) const {
+    const ChunkSection& section = sections[sectionY];
+    if (section.isUniform()) {
+        // Nearly every section of open air or solid stone, no flood fill needed
+        return isTransparent(section.uniformId()) ? SectionConnectivity::all() : SectionConnectivity{};
+    }
+    BlockID ids[SECTION_VOLUME];
+    section.unpack(ids);
+    bool open[SECTION_VOLUME];
+    for (int i = 0; i < SECTION_VOLUME; ++i) {
+        open[i] = isTransparent(ids[i]);
+    }
+    return computeSectionConnectivity(open);
+}
+
+void Chunk::getColumn(int x, int z, BlockID* out) const {
+    for (int sy = 0; sy < SECTIONS_PER_CHUNK; sy++) {
+        for (int ly = 0; ly < SECTION_SIZE; ly++) {
+            *out++ = sections[sy].get(x, ly, z);
+        }
+    }
+}
+
+std::size_t Chunk::memoryUsage() const {
+    std::size_t bytes = sizeof(*this) + combinedData.capacity() * sizeof(PackedFace);
+    for (const ChunkSection& section : sections) {
+        bytes += section.memoryUsage() - sizeof(section);
+    }
+    return bytes;
+}
+
+constexpr std::uint8_t CHUNK_FORMAT_VERSION = 1;
+
+void Chunk::serialize(std::vector<std::uint8_t>& out) const {
+    out.push_back(CHUNK_FORMAT_VERSION);
+    for (const ChunkSection& section : sections) {
+        section.serialize(out);
+    }
+}
+
+bool Chunk::deserialize(const std::uint8_t* data, std::size_t size) {
+    const std::uint8_t* end = data + size;
+    bool valid = size > 0 && *data++ == CHUNK_FORMAT_VERSION;
+    for (ChunkSection& section : sections) {
+        valid = valid && section.deserialize(data, end);
+    }
+    if (!valid || data != end) {
+        // Back to all air, so generating the chunk instead starts from a clean slate
+        for (ChunkSection& section : sections) {
+            section.fill(BlockIds::AIR);
+        }
+        return false;
+    }
+    return true;
+}
+
 void Chunk::generateChunk(int chunkX, int chunkZ) {
-    FastNoiseLite baseNoise, detailNoise, biomeNoise, caveNoise, tunnelNoise;
+    generateTerrain(chunkX, chunkZ);
+    decorate();
+}
 
-    // Set seeds for reproducibility
-    baseNoise.SetSeed(seed);
-    detailNoise.SetSeed(seed);
-    biomeNoise.SetSeed(seed);
-    caveNoise.SetSeed(seed);
-    tunnelNoise.SetSeed(seed);
+constexpr int SEA_LEVEL = 57; // Define a water level (quarter of max height)
+
+SurfaceCache surfaceCache(surfaceCacheTiles, CHUNK_SIZE_Y);
+static_assert(SURFACE_TILE_SIZE % CHUNK_SIZE_X == 0 && SURFACE_TILE_SIZE % CHUNK_SIZE_Z == 0, "Chunks must not straddle surface tiles");
 
-    // Configure noise types and frequencies
-    baseNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-    baseNoise.SetFrequency(0.01f); // Large-scale terrain
+void Chunk::generateTerrain(int chunkX, int chunkZ) {
+    generateTerrain(chunkX, chunkZ, caveLatticeStep);
+}
 
-    detailNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-    detailNoise.SetFrequency(0.05f); // Small-scale features
+std::size_t Chunk::generateTerrain(int chunkX, int chunkZ, LatticeStep caveStep) {
+    FastNoiseLite caveNoise, tunnelNoise;
 
-    biomeNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-    biomeNoise.SetFrequency(0.005f); // Biome distribution
+    // Set seeds for reproducibility
+    caveNoise.SetSeed(seed);
+    tunnelNoise.SetSeed(seed);
 
+    // Configure noise types and frequencies, the 2D fields come from the surface cache
     caveNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
     caveNoise.SetFrequency(0.08f); // Higher frequency for smaller caves
 
     tunnelNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
     tunnelNoise.SetFrequency(0.05f); // Frequency for directional tunnels
 
-    const int SEA_LEVEL = 57; // Define a water level (quarter of max height)
-
-    for (int x = 0; x < CHUNK_SIZE_X; ++x) {
-        for (int z = 0; z < CHUNK_SIZE_Z; ++z) {
-            // Calculate world coordinates
-            double worldX = (chunkX * CHUNK_SIZE_X + x) * 1.0;
-            double worldZ = (chunkZ * CHUNK_SIZE_Z + z) * 1.0;
-
-            // Biome noise determines the biome type
-            double biomeValue = biomeNoise.GetNoise(worldX, worldZ);
-            bool isForest = (biomeValue > 0.2);
-            bool isDesert = (biomeValue < -0.2);
-
-            // Base terrain height
-            double baseHeight = baseNoise.GetNoise(worldX, worldZ) * 10 + 60;
+    const double worldX0 = chunkX * CHUNK_SIZE_X * 1.0;
+    const double worldZ0 = chunkZ * CHUNK_SIZE_Z * 1.0;
+
+    // First pass: the 2D fields of every column, so sections that end up all stone can be filled in one go
+    ColumnSurface surface[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+    surfaceCache.chunkSurface(seed, chunkX * CHUNK_SIZE_X, chunkZ * CHUNK_SIZE_Z, CHUNK_SIZE_X, CHUNK_SIZE_Z, surface);
+    int lowestHeight = CHUNK_SIZE_Y;
+    int highestHeight = 0;
+    for (const ColumnSurface& column : surface) {
+        lowestHeight = std::min(lowestHeight, column.height);
+        highestHeight = std::max(highestHeight, column.height);
+    }
 
-            // Add detail to terrain
-            double detailHeight = detailNoise.GetNoise(worldX, worldZ) * 5;
+    // Sections entirely below the shallowest stone layer are uniform stone until carving touches them
+    int stoneSections = std::max(lowestHeight - 4, 0) / SECTION_SIZE;
+    for (int sy = 0; sy < stoneSections; ++sy) {
+        sections[sy].fill(BlockIds::STONE);
+    }
+    const int stoneTop = stoneSections * SECTION_SIZE;
 
-            // Combine base and detail noise for final terrain height
-            int blockHeight = static_cast<int>(baseHeight + detailHeight);
+    // The 3D fields only matter where carving can change something: caves below the surface, tunnels up to the top
+    // of the highest section with blocks in it. Both are sampled on the cave lattice and interpolated in between.
+    // Per thread since chunks generate on the job system.
+    const int tunnelHeight = std::min((std::max(highestHeight, SEA_LEVEL) / SECTION_SIZE + 1) * SECTION_SIZE, CHUNK_SIZE_Y);
+    thread_local DensityLattice caves;
+    thread_local DensityLattice tunnels;
+    std::size_t samples = caves.fill(caveNoise, caveStep, worldX0, worldZ0, CHUNK_SIZE_X, highestHeight, CHUNK_SIZE_Z);
+    samples += tunnels.fill(tunnelNoise, caveStep, worldX0, worldZ0, CHUNK_SIZE_X, tunnelHeight, CHUNK_SIZE_Z, 0.5, 0.2, 0.5);
 
-            // Clamp block height to the chunk's maximum height
-            blockHeight = std::min(blockHeight, CHUNK_SIZE_Y - 1);
+    for (int x = 0; x < CHUNK_SIZE_X; ++x) {
+        for (int z = 0; z < CHUNK_SIZE_Z; ++z) {
+            const int blockHeight = surface[x * CHUNK_SIZE_Z + z].height;
+            const bool isDesert = surface[x * CHUNK_SIZE_Z + z].desert;
 
-            // Generate terrain layers
-            for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+            // Generate terrain layers, everything above both the surface and the sea stays air
+            const int columnTop = std::max(blockHeight, SEA_LEVEL);
+            for (int y = stoneTop; y < columnTop; ++y) {
                 if (y < blockHeight) {
                     if (y < blockHeight - 4) {
-                        blocks[x][y][z] = Blocks::STONE; // Desert biome uses sand
+                        setBlock(x, y, z, BlockIds::STONE); // Desert biome uses sand
                     } else if (isDesert) {
-                        blocks[x][y][z] = Blocks::SAND; // Underground stone layer
+                        setBlock(x, y, z, BlockIds::SAND); // Underground stone layer
                     } else if (y < blockHeight - 1) {
-                        blocks[x][y][z] = Blocks::DIRT; // Dirt layer
+                        setBlock(x, y, z, BlockIds::DIRT); // Dirt layer
                     } else {
-                        blocks[x][y][z] = Blocks::GRASS_BLOCK; // Top grass layer
+                        setBlock(x, y, z, BlockIds::GRASS_BLOCK); // Top grass layer
                     }
                 } else if (y < SEA_LEVEL) {
-                    blocks[x][y][z] = Blocks::WATER; // Fill water below sea level
+                    setBlock(x, y, z, BlockIds::WATER); // Fill water below sea level
                 }
             }
 
             // Small cave system generation
             for (int y = 0; y < blockHeight; ++y) {
                 // Cave noise for small pockets
-                double caveValue = caveNoise.GetNoise(worldX, y * 1.0, worldZ);
+                double caveValue = caves.at(x, y, z);
                 if (caveValue > 0.55) { // Adjust threshold for small caves
-                    blocks[x][y][z] = Blocks::AIR; // Carve out a small cave
+                    setBlock(x, y, z, BlockIds::AIR); // Carve out a small cave
                 }
             }
 
             // Tunnel generation with directional noise
-            for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+            for (int y = 0; y < tunnelHeight; ++y) {
+                if (sections[y / SECTION_SIZE].isEmpty()) {
+                    y += SECTION_SIZE - 1 - y % SECTION_SIZE; // Nothing to carve in this whole section
+                    continue;
+                }
+                if (getBlockId(x, y, z) == BlockIds::AIR) {
+                    continue;
+                }
                 // Create worm-like tunnels with directional bias
-                double tunnelValue = tunnelNoise.GetNoise(worldX * 0.5, y * 0.2, worldZ * 0.5);
+                double tunnelValue = tunnels.at(x, y, z);
                 if (tunnelValue > 0.65 && tunnelValue < 0.8) { // Narrow range for tunnels
-                    blocks[x][y][z] = Blocks::AIR; // Carve tunnel
+                    setBlock(x, y, z, BlockIds::AIR); // Carve tunnel
                 }
             }
+        }
+    }
+
+    for (ChunkSection& section : sections) {
+        section.compact();
+    }
+    return samples;
+}
+
+void Chunk::decorate() {
+    const WorldRandom random(seed, chunkX, chunkZ);
+    ColumnSurface surface[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+    surfaceCache.chunkSurface(seed, chunkX * CHUNK_SIZE_X, chunkZ * CHUNK_SIZE_Z, CHUNK_SIZE_X, CHUNK_SIZE_Z, surface);
+    for (int x = 0; x < CHUNK_SIZE_X; ++x) {
+        for (int z = 0; z < CHUNK_SIZE_Z; ++z) {
+            const int columnIndex = x * CHUNK_SIZE_Z + z;
+            const ColumnSurface& column = surface[columnIndex];
 
             // Add trees in forest biomes with some probability
-            if (isForest && blockHeight > SEA_LEVEL + 2 && (rand() % 100) < 10) { // 10% chance
-                generateTree(x, blockHeight, z);
+            if (column.forest && column.height > SEA_LEVEL + 2 && random.percent(WorldFeature::Tree, columnIndex, 10)) { // 10% chance
+                generateTree(x, column.height, z);
             }
 
             // Add cacti in desert biomes with some probability
-            if (isDesert && blockHeight > SEA_LEVEL + 2 && (rand() % 100) < 5) { // 5% chance
-                generateCactus(x, blockHeight, z);
+            if (column.desert && column.height > SEA_LEVEL + 2 && random.percent(WorldFeature::Cactus, columnIndex, 5)) { // 5% chance
+                generateCactus(x, column.height, z);
             }
         }
     }
+    for (ChunkSection& section : sections) {
+        section.compact();
+    }
 }
 
 void Chunk::generateCactus(int x, int baseHeight, int z) {
@@ -122,7 +230,8 @@ void Chunk::generateCactus(int x, int baseHeight, int z) {
     const int MIN_CACTUS_HEIGHT = 2; // Minimum cactus height
 
     // Random height for the cactus
-    int cactusHeight = MIN_CACTUS_HEIGHT + (rand() % (MAX_CACTUS_HEIGHT - MIN_CACTUS_HEIGHT + 1));
+    const WorldRandom random(seed, chunkX, chunkZ);
+    int cactusHeight = MIN_CACTUS_HEIGHT + random.nextInt(WorldFeature::CactusHeight, x * CHUNK_SIZE_Z + z, MAX_CACTUS_HEIGHT - MIN_CACTUS_HEIGHT + 1);
 
     // Generate the cactus
     for (int y = 0; y < cactusHeight; ++y) {
@@ -134,7 +243,7 @@ void Chunk::generateCactus(int x, int baseHeight, int z) {
         }
 
         // Place cactus block
-        blocks[x][currentY][z] = Blocks::CACTUS;
+        setBlock(x, currentY, z, BlockIds::CACTUS);
     }
 }
 
@@ -147,251 +256,264 @@ void Chunk::generateTree(int x, int baseHeight, int z) {
     if (x - 2 < 0) return;
 
     // Layer 1
-    blocks[x][baseHeight][z] = Blocks::OAK_LOG;
+    setBlock(x, baseHeight, z, BlockIds::OAK_LOG);
 
     // Layer 2
-    blocks[x][baseHeight + 1][z] = Blocks::OAK_LOG;
+    setBlock(x, baseHeight + 1, z, BlockIds::OAK_LOG);
 
     // Layer 3
     for (int cx = x - 2; cx <= x + 2; ++cx) {
         for (int cz = z - 2; cz <= z + 2; ++cz) {
-            blocks[cx][baseHeight + 2][cz] = Blocks::OAK_LEAVES;
+            setBlock(cx, baseHeight + 2, cz, BlockIds::OAK_LEAVES);
         }
     }
-    blocks[x][baseHeight + 2][z] = Blocks::OAK_LOG;
+    setBlock(x, baseHeight + 2, z, BlockIds::OAK_LOG);
 
     // Layer 4
     for (int cx = x - 2; cx <= x + 2; ++cx) {
         for (int cz = z - 2; cz <= z + 2; ++cz) {
-            blocks[cx][baseHeight + 3][cz] = Blocks::OAK_LEAVES;
+            setBlock(cx, baseHeight + 3, cz, BlockIds::OAK_LEAVES);
         }
     }
-    blocks[x][baseHeight + 3][z] = Blocks::OAK_LOG;
+    setBlock(x, baseHeight + 3, z, BlockIds::OAK_LOG);
 
     // Layer 5
     for (int cx = x - 1; cx <= x + 1; ++cx) {
         for (int cz = z - 1; cz <= z + 1; ++cz) {
-            blocks[cx][baseHeight + 4][cz] = Blocks::OAK_LEAVES;
+            setBlock(cx, baseHeight + 4, cz, BlockIds::OAK_LEAVES);
         }
     }
-    blocks[x][baseHeight + 4][z] = Blocks::OAK_LOG;
+    setBlock(x, baseHeight + 4, z, BlockIds::OAK_LOG);
 
     // Layer 6
-    blocks[x][baseHeight + 5][z] = Blocks::OAK_LEAVES;
-    blocks[x][baseHeight + 5][z - 1] = Blocks::OAK_LEAVES;
-    blocks[x][baseHeight + 5][z + 1] = Blocks::OAK_LEAVES;
-    blocks[x - 1][baseHeight + 5][z] = Blocks::OAK_LEAVES;
-    blocks[x + 1][baseHeight + 5][z] = Blocks::OAK_LEAVES;
+    setBlock(x, baseHeight + 5, z, BlockIds::OAK_LEAVES);
+    setBlock(x, baseHeight + 5, z - 1, BlockIds::OAK_LEAVES);
+    setBlock(x, baseHeight + 5, z + 1, BlockIds::OAK_LEAVES);
+    setBlock(x - 1, baseHeight + 5, z, BlockIds::OAK_LEAVES);
+    setBlock(x + 1, baseHeight + 5, z, BlockIds::OAK_LEAVES);
 }
 
-void Chunk::generateChunkData(int x, int z, Chunk* positiveX, Chunk* negativeX, Chunk* positiveZ, Chunk* negativeZ) {
-    std::cout << "var\n";
-    std::vector<glm::vec2> aTexOffsetOverlay;
-    std::vector<glm::vec2> aTexOffset;
-    std::vector<glm::mat4> models;
-    std::vector<bool> visibility;
-    std::vector<glm::vec3> normals;
-    int size = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z * 6;
-    aTexOffsetOverlay.resize(size);
-    aTexOffset.resize(size);
-    models.resize(size);
-    visibility.resize(size);
-    normals.resize(size);
-    std::cout << "data\n";
-    for (int cx = 0; cx < CHUNK_SIZE_X; cx++) {
-        for (int cy = 0; cy < CHUNK_SIZE_Y; cy++) {
-            for (int cz = 0; cz < CHUNK_SIZE_Z; cz++) {
-                glm::vec3 blockLocation = glm::vec3(cx + chunkX * CHUNK_SIZE_X, cy, cz + chunkZ * CHUNK_SIZE_Z);
-                for (int i = 0; i < 6; i++) {
-                    // Calculate the flat index
-                    int index = ((cx * CHUNK_SIZE_Y * CHUNK_SIZE_Z) + (cy * CHUNK_SIZE_Z) + cz) * 6 + i;
+// Mesher scratch memory, one per thread and kept alive between calls. Once the buffers have grown to the largest
+// chunk a thread has seen, meshing does not touch the heap apart from sizing the chunk's own combinedData.
+struct MeshScratch {
+    std::vector<BlockID> blocks; // The chunk decoded column by column, see blockIndex()
+    std::vector<PackedFace> faces; // Visible faces, only as long as the chunk needs
+    BlockID section[ChunkSection::Storage::VOLUME]; // One section in storage order, before it is scattered into blocks
+    BlockID border[CHUNK_SIZE_Y]; // A neighbour chunk's column next to ours
+    FaceCullInput cullInput;
+    FaceCullOutput visible;
+
+    static int blockIndex(int x, int y, int z) {
+        return (x * CHUNK_SIZE_Z + z) * CHUNK_SIZE_Y + y;
+    }
+};
 
-                    if (blocks[cx][cy][cz] == Blocks::AIR) {
-                        continue;
-                    }
-                    switch (i) {
-                        case 0: // Back face
-                            if (cz - 1 < 0) {
-                                if (negativeZ != nullptr && negativeZ->blocks[cx][cy][CHUNK_SIZE_Z - 1].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == negativeZ->blocks[cx][cy][CHUNK_SIZE_Z - 1])) {
-                                    visibility[index] = true;
-                                }
-                            } else if (blocks[cx][cy][cz - 1].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == blocks[cx][cy][cz - 1])) {
-                                visibility[index] = true;
-                            }
-                            break;
-
-                        case 1: // Front face
-                            if (cz + 1 >= CHUNK_SIZE_Z) {
-                                if (positiveZ != nullptr && positiveZ->blocks[cx][cy][0].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == positiveZ->blocks[cx][cy][0])) {
-                                    visibility[index] = true;
-                                }
-                            } else if (blocks[cx][cy][cz + 1].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == blocks[cx][cy][cz + 1])) {
-                                visibility[index] = true;
-                            }
-                            break;
-
-                        case 2: // Left face
-                            if (cx - 1 < 0) {
-                                if (negativeX != nullptr && negativeX->blocks[CHUNK_SIZE_X - 1][cy][cz].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == negativeX->blocks[CHUNK_SIZE_X - 1][cy][cz])) {
-                                    visibility[index] = true;
-                                }
-                            } else if (blocks[cx - 1][cy][cz].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == blocks[cx - 1][cy][cz])) {
-                                visibility[index] = true;
-                            }
-                            break;
-
-                        case 3: // Right face
-                            if (cx + 1 >= CHUNK_SIZE_X) {
-                                if (positiveX != nullptr && positiveX->blocks[0][cy][cz].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == positiveX->blocks[0][cy][cz])) {
-                                    visibility[index] = true;
-                                }
-                            } else if (blocks[cx + 1][cy][cz].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == blocks[cx + 1][cy][cz])) {
-                                visibility[index] = true;
-                            }
-                            break;
+inline thread_local MeshScratch meshScratch;
 
-                        case 4: // Top face
-                            if (cy + 1 >= CHUNK_SIZE_Y || blocks[cx][cy + 1][cz].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == blocks[cx][cy + 1][cz])) {
-                                visibility[index] = true;
-                            }
-                            break;
+constexpr BlockMask NON_AIR_BLOCKS = ~(BlockMask{1} << BlockIds::AIR);
 
-                        case 5: // Bottom face
-                            if (cy - 1 < 0 || blocks[cx][cy - 1][cz].isTransparent && !(blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] == blocks[cx][cy - 1][cz])) {
-                                visibility[index] = true;
-                            }
-                            break;
-                        default: ;
-                    }
+// Fills the culling masks of padded column p from the 128 ids of one column
+inline void setCullColumn(FaceCullInput& in, int p, const BlockID* column) {
+    static_assert(CHUNK_SIZE_Y == CULL_COLUMN_HEIGHT);
+    in.solid[p] = {blockMask64(column, NON_AIR_BLOCKS), blockMask64(column + 64, NON_AIR_BLOCKS)};
+    in.transparent[p] = {blockMask64(column, TRANSPARENT_BLOCKS), blockMask64(column + 64, TRANSPARENT_BLOCKS)};
+    for (int k = 0; k < LIQUID_COUNT; k++) {
+        const BlockMask liquid = BlockMask{1} << LIQUID_IDS[k];
+        in.liquid[k][p] = {blockMask64(column, liquid), blockMask64(column + 64, liquid)};
+    }
+}
 
-                    if (visibility[index] == false) {
-                        continue;
-                    }
+inline void clearCullColumn(FaceCullInput& in, int p) {
+    in.solid[p] = {};
+    in.transparent[p] = {};
+    for (int k = 0; k < LIQUID_SLOTS; k++) {
+        in.liquid[k][p] = {};
+    }
+}
 
-                    // Assign texture offsets
-                    aTexOffset[index] = blocks[cx][cy][cz].textureOffsets[i];
-                    aTexOffsetOverlay[index] = blocks[cx][cy][cz].textureOffsetOverlays[i];
+// How a face's local quad axes lie in the chunk, see decodeFaceVertex(): the face normal is along normalAxis,
+// quad x runs along uAxis and quad y along vAxis (0 = x, 1 = y, 2 = z), each towards +1 or -1
+struct FaceAxes {
+    int normalAxis;
+    int uAxis, uSign;
+    int vAxis, vSign;
+};
+
+constexpr FaceAxes FACE_AXES[6] = {
+    {2, 0, 1, 1, 1},
+    {2, 0, -1, 1, 1},
+    {0, 2, -1, 1, 1},
+    {0, 2, 1, 1, 1},
+    {1, 0, 1, 2, 1},
+    {1, 0, 1, 2, -1}
+};
+
+void Chunk::generateChunkData(int x, int z, Chunk* positiveX, Chunk* negativeX, Chunk* positiveZ, Chunk* negativeZ, MeshingMode mode) {
+    buildMesh(mode, positiveX, negativeX, positiveZ, negativeZ, meshScratch.faces);
+    combinedData.assign(meshScratch.faces.begin(), meshScratch.faces.end());
+}
 
-                    // Calculate the model matrix
-                    glm::mat4 model = glm::translate(glm::mat4(1.0f), blockLocation);
-                    if (blocks[cx][cy][cz] == Blocks::CACTUS) {
-                        switch (i) {
-                            case 0:
-                                model = glm::translate(glm::mat4(1.0f), glm::vec3(blockLocation.x, blockLocation.y, blockLocation.z + 1.0f / 16));
-                                break;
-                            case 1:
-                                model = glm::translate(glm::mat4(1.0f), glm::vec3(blockLocation.x, blockLocation.y, blockLocation.z - 1.0f / 16));
-                                break;
-                            case 2:
-                                model = glm::translate(glm::mat4(1.0f), glm::vec3(blockLocation.x + 1.0f / 16, blockLocation.y, blockLocation.z));
-                                break;
-                            case 3:
-                                model = glm::translate(glm::mat4(1.0f), glm::vec3(blockLocation.x - 1.0f / 16, blockLocation.y, blockLocation.z));
-                                break;
-                            default: ;
-                        }
+void Chunk::buildMesh(MeshingMode mode, const Chunk* positiveX, const Chunk* negativeX, const Chunk* positiveZ, const Chunk* negativeZ,
+                      std::vector<PackedFace>& faces) const {
+    MeshScratch& scratch = meshScratch;
+    scratch.blocks.resize(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z);
+    faces.clear();
+    // Every section is written, empty ones included, so nothing of the previous chunk is left in the buffer
+    for (int sy = 0; sy < SECTIONS_PER_CHUNK; sy++) {
+        const ChunkSection& section = sections[sy];
+        for (int x = 0; x < CHUNK_SIZE_X; x++) {
+            for (int z = 0; z < CHUNK_SIZE_Z; z++) {
+                BlockID* column = &scratch.blocks[MeshScratch::blockIndex(x, sy * SECTION_SIZE, z)];
+                if (section.isUniform()) {
+                    std::fill(column, column + SECTION_SIZE, section.uniformId());
+                } else {
+                    if (x == 0 && z == 0) {
+                        section.unpack(scratch.section);
                     }
-                    switch (i) {
-                        case 0:
-                            normals[index] = glm::vec3(0.0f,  0.0f, -1.0f);
-                            if (blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] != blocks[cx][cy + 1][cz]) {
-                                model = glm::scale(model, glm::vec3(1.0f, 1.0f - 1.0f / 16, 1.0f));
-                                model = glm::translate(model, glm::vec3(0.0f, -1.0f / 32, 0.0f));
-                            }
-                            break; // Front face
-                        case 1:
-                            normals[index] = glm::vec3(0.0f,  0.0f, 1.0f);
-                            if (blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] != blocks[cx][cy + 1][cz]) {
-                                model = glm::scale(model, glm::vec3(1.0f, 1.0f - 1.0f / 16, 1.0f));
-                                model = glm::translate(model, glm::vec3(0.0f, -1.0f / 32, 0.0f));
-                            }
-                            model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                            break; // Back face
-                        case 2:
-                            normals[index] = glm::vec3(-1.0f,  0.0f, 0.0f);
-                            if (blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] != blocks[cx][cy + 1][cz]) {
-                                model = glm::scale(model, glm::vec3(1.0f, 1.0f - 1.0f / 16, 1.0f));
-                                model = glm::translate(model, glm::vec3(0.0f, -1.0f / 32, 0.0f));
-                            }
-                            model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                            break; // Left face
-                        case 3:
-                            normals[index] = glm::vec3(1.0f,  0.0f, 0.0f);
-                            if (blocks[cx][cy][cz].isLiquid && blocks[cx][cy][cz] != blocks[cx][cy + 1][cz]) {
-                                model = glm::scale(model, glm::vec3(1.0f, 1.0f - 1.0f / 16, 1.0f));
-                                model = glm::translate(model, glm::vec3(0.0f, -1.0f / 32, 0.0f));
-                            }
-                            model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-                            break; // Right face
-                        case 4:
-                            normals[index] = glm::vec3(0.0f,  1.0f, 0.0f);
-                            if (blocks[cx][cy][cz].isLiquid) model = glm::translate(glm::mat4(1.0f), glm::vec3(blockLocation.x, blockLocation.y - 1.0f / 16, blockLocation.z));
-                            model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-                            break; // Top face
-                        case 5:
-                            normals[index] = glm::vec3(0.0f,  -1.0f, 0.0f);
-                            model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-                            break; // Bottom face
-                        default: ;
+                    for (int ly = 0; ly < SECTION_SIZE; ly++) {
+                        column[ly] = scratch.section[ChunkSection::Storage::index(x, ly, z)];
                     }
-
-                    // Assign the model matrix
-                    models[index] = model;
-
                 }
             }
         }
     }
-    std::cout << "size before: " << models.size() << std::endl;
-    std::cout << "vis\n";
-    size_t writeIndex = 0; // Tracks the index for writing valid elements
-    for (size_t readIndex = 0; readIndex < visibility.size(); ++readIndex) {
-        if (visibility[readIndex]) {
-            // Keep valid elements
-            aTexOffset[writeIndex] = aTexOffset[readIndex];
-            aTexOffsetOverlay[writeIndex] = aTexOffsetOverlay[readIndex];
-            models[writeIndex] = models[readIndex];
-            visibility[writeIndex] = visibility[readIndex];
-            normals[writeIndex] = normals[readIndex];
-            ++writeIndex;
+    const BlockID* blocks = scratch.blocks.data();
+
+    // Visibility of every face comes from the bitmask kernel, a missing neighbour leaves its border columns opaque
+    FaceCullInput& cull = scratch.cullInput;
+    for (int x = 0; x < CHUNK_SIZE_X; x++) {
+        for (int z = 0; z < CHUNK_SIZE_Z; z++) {
+            setCullColumn(cull, FaceCullInput::paddedIndex(x + 1, z + 1), &blocks[MeshScratch::blockIndex(x, 0, z)]);
         }
     }
-    aTexOffset.resize(writeIndex);
-    aTexOffsetOverlay.resize(writeIndex);
-    models.resize(writeIndex);
-    visibility.resize(writeIndex);
-    normals.resize(writeIndex);
-
-
-    if (models.size() == visibility.size() && visibility.size() == aTexOffset.size() && aTexOffset.size() == aTexOffsetOverlay.size()) {
-        std::cout << "All vectors are the same size: " << models.size() << std::endl;
-        size = static_cast<int>(models.size());
-    } else {
-        std::cout << "Vectors are not the same size" << std::endl;
+    auto setBorder = [&](const Chunk* neighbour, int px, int pz, int nx, int nz) {
+        if (neighbour == nullptr) {
+            clearCullColumn(cull, FaceCullInput::paddedIndex(px, pz));
+            return;
+        }
+        neighbour->getColumn(nx, nz, scratch.border);
+        setCullColumn(cull, FaceCullInput::paddedIndex(px, pz), scratch.border);
+    };
+    for (int i = 0; i < CHUNK_SIZE_Z; i++) {
+        setBorder(negativeX, 0, i + 1, CHUNK_SIZE_X - 1, i);
+        setBorder(positiveX, CHUNK_SIZE_X + 1, i + 1, 0, i);
+    }
+    for (int i = 0; i < CHUNK_SIZE_X; i++) {
+        setBorder(negativeZ, i + 1, 0, i, CHUNK_SIZE_Z - 1);
+        setBorder(positiveZ, i + 1, CHUNK_SIZE_Z + 1, i, 0);
+    }
+    cullFaces(cull, scratch.visible);
+    const FaceCullOutput& visible = scratch.visible;
+
+    // Everything that decides how face i of block (cx, cy, cz) looks, packed as encodeFace's texture word plus the
+    // shape flags above it. Zero if the face is hidden, so equal non-zero keys can be merged into one quad.
+    auto faceKey = [&](int cx, int cy, int cz, int i) -> std::uint32_t {
+        if (!visible.visible[i][cx * CHUNK_SIZE_Z + cz].test(cy)) {
+            return 0;
+        }
+        const int index = MeshScratch::blockIndex(cx, cy, cz);
+        const BlockID block = blocks[index];
+        std::uint32_t flags = 0;
+        if (block == BlockIds::CACTUS && i < static_cast<int>(FACE_POS_Y)) {
+            flags |= FACE_CACTUS_INSET;
+        }
+        if (isLiquid(block)) {
+            const BlockID above = cy + 1 < CHUNK_SIZE_Y ? blocks[index + 1] : BlockIds::AIR;
+            if (i == static_cast<int>(FACE_POS_Y) || (i < static_cast<int>(FACE_POS_Y) && block != above)) {
+                flags |= FACE_LIQUID_LOWERED;
+            }
+        }
+        return encodeFace(0, 0, 0, 0, 0, FACE_TILES[block][i], FACE_OVERLAY_TILES[block][i]).texture | flags << 16 | 1u << 31;
+    };
+    auto emit = [&faces](int cx, int cy, int cz, int i, std::uint32_t key, int width, int height) {
+        faces.push_back(encodeFace(cx, cy, cz, i, key >> 16 & 0x3, key & 0xFF, key >> 8 & 0xFF, width, height));
+    };
+
+    if (mode == MeshingMode::PerFace) {
+        // Faces are emitted in (x, z, y, face) order, walking only the set bits of each column
+        for (int cx = 0; cx < CHUNK_SIZE_X; cx++) {
+            for (int cz = 0; cz < CHUNK_SIZE_Z; cz++) {
+                const int c = cx * CHUNK_SIZE_Z + cz;
+                std::uint64_t any[2] = {0, 0};
+                for (int i = 0; i < 6; i++) {
+                    any[0] |= visible.visible[i][c].lo;
+                    any[1] |= visible.visible[i][c].hi;
+                }
+                for (int half = 0; half < 2; half++) {
+                    for (std::uint64_t bits = any[half]; bits != 0; bits &= bits - 1) {
+                        const int cy = half * 64 + std::countr_zero(bits);
+                        for (int i = 0; i < 6; i++) {
+                            if (const std::uint32_t key = faceKey(cx, cy, cz, i)) {
+                                emit(cx, cy, cz, i, key, 1, 1);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return;
     }
-    std::cout << "hallo" << std::endl;
-    combinedData = std::vector<float>(size * (2 + 2 + 16 + 3)); // 2 floats for each vec2, 16 floats for mat4
-    std::cout << "comb\n";
-    for (size_t i = 0; i < size; ++i) {
-        // Add aTexOffset
-        combinedData[i * 23 + 0] = aTexOffset[i].x;
-        combinedData[i * 23 + 1] = aTexOffset[i].y;
-
-        // Add aTexOffsetOverlay
-        combinedData[i * 23 + 2] = aTexOffsetOverlay[i].x;
-        combinedData[i * 23 + 3] = aTexOffsetOverlay[i].y;
-
-        // Add model matrix
-        const glm::mat4& mat = models[i];
-
-        for (int j = 0; j < 4; ++j) {
-            combinedData[i * 23 + 4 + 4 * j + 0] = mat[j].x;
-            combinedData[i * 23 + 4 + 4 * j + 1] = mat[j].y;
-            combinedData[i * 23 + 4 + 4 * j + 2] = mat[j].z;
-            combinedData[i * 23 + 4 + 4 * j + 3] = mat[j].w;
+
+    // Greedy meshing: per section, face direction and slice, merge equal keys into the largest rectangles in the
+    // slice. Quads never leave their section, which keeps width and height within MAX_QUAD_SIZE.
+    static_assert(SECTION_SIZE == MAX_QUAD_SIZE && CHUNK_SIZE_X == SECTION_SIZE && CHUNK_SIZE_Z == SECTION_SIZE);
+    std::uint32_t mask[SECTION_SIZE][SECTION_SIZE];
+    for (int sy = 0; sy < SECTIONS_PER_CHUNK; sy++) {
+        if (sections[sy].isEmpty()) {
+            continue;
+        }
+        const int base[3] = {0, sy * SECTION_SIZE, 0};
+        for (int i = 0; i < 6; i++) {
+            const FaceAxes& axes = FACE_AXES[i];
+            for (int n = 0; n < SECTION_SIZE; n++) {
+                // mask[v][u] holds the key of the face at slice n, with u and v counting up along the world axes
+                int pos[3];
+                pos[axes.normalAxis] = base[axes.normalAxis] + n;
+                for (int v = 0; v < SECTION_SIZE; v++) {
+                    pos[axes.vAxis] = base[axes.vAxis] + v;
+                    for (int u = 0; u < SECTION_SIZE; u++) {
+                        pos[axes.uAxis] = base[axes.uAxis] + u;
+                        mask[v][u] = faceKey(pos[0], pos[1], pos[2], i);
+                    }
+                }
+
+                for (int v = 0; v < SECTION_SIZE; v++) {
+                    for (int u = 0; u < SECTION_SIZE; u++) {
+                        const std::uint32_t key = mask[v][u];
+                        if (key == 0) {
+                            continue;
+                        }
+                        int width = 1;
+                        while (u + width < SECTION_SIZE && mask[v][u + width] == key) {
+                            width++;
+                        }
+                        // Lowered liquid sides are shaped per block, so they only merge sideways
+                        const bool rowOnly = (key >> 16 & FACE_LIQUID_LOWERED) && i < static_cast<int>(FACE_POS_Y);
+                        int height = 1;
+                        while (!rowOnly && v + height < SECTION_SIZE) {
+                            bool rowMatches = true;
+                            for (int k = 0; k < width && rowMatches; k++) {
+                                rowMatches = mask[v + height][u + k] == key;
+                            }
+                            if (!rowMatches) {
+                                break;
+                            }
+                            height++;
+                        }
+                        for (int dv = 0; dv < height; dv++) {
+                            for (int du = 0; du < width; du++) {
+                                mask[v + dv][u + du] = 0;
+                            }
+                        }
+
+                        // The quad starts at its corner with the lowest local x and y, which is the far end of the
+                        // rectangle along any axis the face runs backwards on
+                        pos[axes.uAxis] = base[axes.uAxis] + (axes.uSign > 0 ? u : u + width - 1);
+                        pos[axes.vAxis] = base[axes.vAxis] + (axes.vSign > 0 ? v : v + height - 1);
+                        emit(pos[0], pos[1], pos[2], i, key, width, height);
+                    }
+                }
+            }
         }
-        combinedData[i * 23 + 20] = normals[i].x;
-        combinedData[i * 23 + 21] = normals[i].y;
-        combinedData[i * 23 + 22] = normals[i].z;
     }
 }
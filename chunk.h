@@ -7,30 +7,78 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
-#include "block.cpp"
+#include "chunk_section.h"
+#include "chunk_stage.h"
+#include "density_lattice.h"
+#include "face_format.h"
+#include "section_visibility.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <optional>
 
 constexpr int CHUNK_SIZE_X = 16;
 constexpr int CHUNK_SIZE_Y = 128;
 constexpr int CHUNK_SIZE_Z = 16;
+constexpr int SECTIONS_PER_CHUNK = CHUNK_SIZE_Y / SECTION_SIZE;
+
+enum class MeshingMode {
+    PerFace, // One quad per visible block face
+    Greedy   // Coplanar faces that look the same merged into larger quads
+};
 
 class Chunk {
 public:
-    std::vector<float> combinedData;
+    std::vector<PackedFace> combinedData; // Visible faces, positions relative to the chunk origin
 
+    // Load pipeline bookkeeping, only touched with the chunk map's mutex held. The stage alone may also be read
+    // without it.
+    std::atomic<ChunkStage> stage = ChunkStage::Allocated;
+    bool stageJobQueued = false; // A job advancing this chunk to its next stage is queued or running
+    int jobRefs = 0;             // Queued or running jobs reading or writing this chunk, it stays loaded while non-zero
+    bool dirty = false;          // Blocks differ from what the world store holds, saved when the chunk is unloaded
+    // Set while the player waits for the chunk's faces, see FirstGeometryStats
+    std::optional<std::chrono::steady_clock::time_point> waitingSince = std::chrono::steady_clock::now();
+
+    // Only sets the position, the blocks come from generateChunk() or the two generation stages
     inline Chunk(int chunkX, int chunkZ);
 
     inline bool operator==(const Chunk& other) const;
 
+    // Both generation stages in one go
     inline void generateChunk(int chunkX, int chunkZ);
+    inline void generateTerrain(int chunkX, int chunkZ);
+    // Same with the caves and tunnels sampled on the given lattice instead of caveLatticeStep from the settings,
+    // returns the number of 3D noise samples taken
+    inline std::size_t generateTerrain(int chunkX, int chunkZ, LatticeStep caveStep);
+    // Places trees and cacti, needs generateTerrain() first. Everything placed stays inside the chunk.
+    inline void decorate();
+    // The blocks in the world store format, see ChunkSection::serialize(). Only meaningful once decorated.
+    inline void serialize(std::vector<std::uint8_t>& out) const;
+    // Replaces the blocks with ones written by serialize(), false and all air if the data is malformed
+    inline bool deserialize(const std::uint8_t* data, std::size_t size);
     inline void setupBuffer();
-    inline void generateChunkData(int x, int z, Chunk* positiveX, Chunk* negativeX, Chunk* positiveZ, Chunk* negativeZ);
+    inline void generateChunkData(int x, int z, Chunk* positiveX, Chunk* negativeX, Chunk* positiveZ, Chunk* negativeZ,
+                                  MeshingMode mode = MeshingMode::Greedy);
+    // Meshes the chunk into faces without touching combinedData, neighbours may be null
+    inline void buildMesh(MeshingMode mode, const Chunk* positiveX, const Chunk* negativeX, const Chunk* positiveZ, const Chunk* negativeZ,
+                          std::vector<PackedFace>& faces) const;
     inline void generateTree(int x, int baseHeight, int z);
     inline void generateCactus(int x, int baseHeight, int z);
+
+    inline const Block& getBlock(int x, int y, int z) const;
+    inline BlockID getBlockId(int x, int y, int z) const;
+    inline void setBlock(int x, int y, int z, BlockID id);
+    inline std::size_t memoryUsage() const;
+    inline const ChunkSection& getSection(int sectionY) const;
+    // Which faces of a section see each other through transparent blocks, recomputed from the blocks on every call
+    inline SectionConnectivity sectionConnectivity(int sectionY) const;
+    // Copies the ids of column (x, z) bottom to top into out[0..CHUNK_SIZE_Y)
+    inline void getColumn(int x, int z, BlockID* out) const;
 private:
     int chunkX; // X coordinate of the chunk
     int chunkZ; // Z coordinate of the chunk
-    std::vector<std::vector<std::vector<Block>>> blocks;
+    std::array<ChunkSection, SECTIONS_PER_CHUNK> sections; // Bottom to top, one per 16 blocks of height
 };
 
 #endif // CHUNK_H
\ No newline at end of file
@@ -0,0 +1,246 @@
+#ifndef CHUNK_INDEX_H
+#define CHUNK_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using ChunkPosition = std::pair<int, int>; // Chunk x, z
+
+// Both coordinates in one 64-bit key, x in the high half
+constexpr std::uint64_t packChunkPosition(ChunkPosition position) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(position.first)) << 32 | static_cast<std::uint32_t>(position.second);
+}
+
+// Chunk position -> Value in one open addressing table, a drop-in for the std::map subset the chunk code uses.
+// Probing compares packed 64-bit keys in an array of their own, so a lookup touches one or two cache lines instead
+// of walking a tree. Robin Hood insertion keeps every entry close to its home slot, and erasing shifts the following
+// entries back instead of leaving tombstones. Iteration order is unspecified. Inserting or erasing invalidates
+// iterators and references, like std::unordered_map on rehash. Value has to be default constructible, empty slots
+// hold a default value.
+template <typename Value>
+class ChunkIndex {
+public:
+    using key_type = ChunkPosition;
+    using mapped_type = Value;
+    using value_type = std::pair<ChunkPosition, Value>;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ChunkIndex::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+        Iterator() = default;
+        // Lets an iterator convert to a const_iterator
+        template <bool OtherConst> requires (Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) : index(other.index), slot(other.slot) {}
+
+        reference operator*() const { return index->entries[slot]; }
+        pointer operator->() const { return &index->entries[slot]; }
+
+        Iterator& operator++() {
+            slot = index->nextOccupied(slot + 1);
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const { return slot == other.slot; }
+
+    private:
+        friend class ChunkIndex;
+        template <bool> friend class Iterator;
+        using Index = std::conditional_t<Const, const ChunkIndex, ChunkIndex>;
+        Index* index = nullptr;
+        std::size_t slot = 0;
+
+        Iterator(Index* index, std::size_t slot) : index(index), slot(slot) {}
+    };
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    ChunkIndex() = default;
+
+    iterator begin() { return {this, nextOccupied(0)}; }
+    iterator end() { return {this, capacity()}; }
+    const_iterator begin() const { return {this, nextOccupied(0)}; }
+    const_iterator end() const { return {this, capacity()}; }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    iterator find(ChunkPosition position) {
+        return {this, findSlot(packChunkPosition(position))};
+    }
+
+    const_iterator find(ChunkPosition position) const {
+        return {this, findSlot(packChunkPosition(position))};
+    }
+
+    bool contains(ChunkPosition position) const {
+        return findSlot(packChunkPosition(position)) != capacity();
+    }
+
+    Value& at(ChunkPosition position) {
+        const std::size_t slot = findSlot(packChunkPosition(position));
+        if (slot == capacity()) throw std::out_of_range("ChunkIndex::at");
+        return entries[slot].second;
+    }
+
+    const Value& at(ChunkPosition position) const {
+        const std::size_t slot = findSlot(packChunkPosition(position));
+        if (slot == capacity()) throw std::out_of_range("ChunkIndex::at");
+        return entries[slot].second;
+    }
+
+    // Inserts unless the position is there already, returns where the position's entry is and whether it is new
+    std::pair<iterator, bool> emplace(ChunkPosition position, Value value) {
+        const std::uint64_t key = packChunkPosition(position);
+        const std::size_t existing = findSlot(key);
+        if (existing != capacity()) {
+            return {iterator(this, existing), false};
+        }
+        if ((count + 1) * 8 > capacity() * 7) {
+            rehash(capacity() == 0 ? 16 : capacity() * 2);
+        }
+        return {iterator(this, insertNew(key, value_type(position, std::move(value)))), true};
+    }
+
+    std::size_t erase(ChunkPosition position) {
+        std::size_t slot = findSlot(packChunkPosition(position));
+        if (slot == capacity()) return 0;
+        // Backward shift: move every following entry that isn't in its home slot one back
+        const std::size_t mask = capacity() - 1;
+        std::size_t next = (slot + 1) & mask;
+        while (distances[next] > 1) {
+            keys[slot] = keys[next];
+            distances[slot] = static_cast<std::uint8_t>(distances[next] - 1);
+            entries[slot] = std::move(entries[next]);
+            slot = next;
+            next = (next + 1) & mask;
+        }
+        distances[slot] = 0;
+        entries[slot] = value_type();
+        count--;
+        return 1;
+    }
+
+    void clear() {
+        keys.clear();
+        distances.clear();
+        entries.clear();
+        count = 0;
+    }
+
+    // Room for at least n entries without rehashing
+    void reserve(std::size_t n) {
+        std::size_t target = 16;
+        while (target * 7 < n * 8) target *= 2;
+        if (target > capacity()) rehash(target);
+    }
+
+private:
+    // Slot i is empty while distances[i] is 0, otherwise it holds keys[i] and entries[i] at distances[i] - 1 slots
+    // past its home slot
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint8_t> distances;
+    std::vector<value_type> entries;
+    std::size_t count = 0;
+    int shift = 64; // 64 - log2(capacity)
+
+    std::size_t capacity() const {
+        return distances.size();
+    }
+
+    // Fibonacci hashing, the high bits of key times 2^64 / phi. Neighbouring chunks end up far apart.
+    std::size_t home(std::uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    // capacity() if absent. Stops as soon as the probe is further from home than the entry it looks at, which no
+    // entry for key could be past in a Robin Hood table.
+    std::size_t findSlot(std::uint64_t key) const {
+        if (count == 0) return capacity();
+        const std::size_t mask = capacity() - 1;
+        std::size_t slot = home(key);
+        for (std::uint8_t distance = 1; distance <= distances[slot]; ++distance) {
+            if (keys[slot] == key) return slot;
+            slot = (slot + 1) & mask;
+        }
+        return capacity();
+    }
+
+    std::size_t nextOccupied(std::size_t slot) const {
+        while (slot < capacity() && distances[slot] == 0) slot++;
+        return slot;
+    }
+
+    // key must not be present and there must be room. Returns the slot the new entry ended up in.
+    std::size_t insertNew(std::uint64_t key, value_type entry) {
+        const std::uint64_t inserted = key;
+        const std::size_t mask = capacity() - 1;
+        std::size_t slot = home(key);
+        std::uint8_t distance = 1;
+        std::size_t placed = capacity();
+        while (true) {
+            if (distances[slot] == 0) {
+                keys[slot] = key;
+                distances[slot] = distance;
+                entries[slot] = std::move(entry);
+                count++;
+                return placed == capacity() ? slot : placed;
+            }
+            if (distances[slot] < distance) {
+                // Take the slot from an entry closer to its home and carry that one further
+                std::swap(keys[slot], key);
+                std::swap(distances[slot], distance);
+                std::swap(entries[slot], entry);
+                if (placed == capacity()) placed = slot;
+            }
+            slot = (slot + 1) & mask;
+            if (++distance == 0xFF) {
+                // Probe lengths this long only come from a hopeless key distribution. Grow, then place whatever
+                // entry is being carried; the inserted one may already sit in the table by now.
+                rehash(capacity() * 2);
+                insertNew(key, std::move(entry));
+                return findSlot(inserted);
+            }
+        }
+    }
+
+    void rehash(std::size_t newCapacity) {
+        std::vector<std::uint64_t> oldKeys = std::move(keys);
+        std::vector<std::uint8_t> oldDistances = std::move(distances);
+        std::vector<value_type> oldEntries = std::move(entries);
+        keys.assign(newCapacity, 0);
+        distances.assign(newCapacity, 0);
+        entries.assign(newCapacity, value_type());
+        count = 0;
+        shift = 64;
+        for (std::size_t c = newCapacity; c > 1; c >>= 1) shift--;
+        for (std::size_t i = 0; i < oldDistances.size(); ++i) {
+            if (oldDistances[i] != 0) {
+                insertNew(oldKeys[i], std::move(oldEntries[i]));
+            }
+        }
+    }
+};
+
+#endif // CHUNK_INDEX_H
@@ -0,0 +1,399 @@
+#ifndef CHUNK_PIPELINE_H
+#define CHUNK_PIPELINE_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "chunk.h"
+#include "chunk_index.h"
+#include "chunk_prefetch.h"
+#include "chunk_stage.h"
+#include "frustum_culling.h"
+#include "job_system.h"
+#include "snapshot_map.h"
+#include "world_store.h"
+
+// Loaded chunks. Anything holding a chunk's pointer keeps it alive, so unloading never frees a chunk under a job
+// or a reader of an older snapshot.
+using ChunkMap = SnapshotMap<ChunkPosition, Chunk, ChunkIndex<std::shared_ptr<Chunk>>>;
+
+// Faces of a chunk whose Meshed stage just finished, for the main thread to upload
+struct ChunkMesh {
+    int chunkX;
+    int chunkZ;
+    SlabHandle chunk; // The chunk that was meshed, only uploaded while it is still the loaded one
+    std::vector<PackedFace> faces; // Grouped by the section they start in, bottom to top
+    std::array<std::uint32_t, SECTIONS_PER_CHUNK + 1> sectionStarts; // Faces of section s are [sectionStarts[s], sectionStarts[s + 1])
+    std::array<SectionConnectivity, SECTIONS_PER_CHUNK> connectivity; // For the cave culling walk, bottom to top
+    std::chrono::steady_clock::time_point meshedAt;
+};
+
+// Stable counting sort of faces by the section their start block is in, so each section's faces can be drawn as
+// one range. Returns where each section's faces begin, with the total face count at the end.
+inline std::array<std::uint32_t, SECTIONS_PER_CHUNK + 1> groupFacesBySection(std::vector<PackedFace>& faces) {
+    std::array<std::uint32_t, SECTIONS_PER_CHUNK + 1> starts{};
+    for (const PackedFace& face : faces) {
+        starts[decodeFace(face).y / SECTION_SIZE + 1]++;
+    }
+    for (int s = 0; s < SECTIONS_PER_CHUNK; ++s) {
+        starts[s + 1] += starts[s];
+    }
+    std::vector<PackedFace> grouped(faces.size());
+    std::array<std::uint32_t, SECTIONS_PER_CHUNK + 1> next = starts;
+    for (const PackedFace& face : faces) {
+        grouped[next[decodeFace(face).y / SECTION_SIZE]++] = face;
+    }
+    faces.swap(grouped);
+    return starts;
+}
+
+// Chunks out of view are worked on as if they were this many times further from the camera
+constexpr float OUT_OF_VIEW_DISTANCE_FACTOR = 2.0f;
+
+// What a chunk and its four direct neighbours must have reached before the job producing a stage may run
+struct StagePrerequisites {
+    bool needsNeighbours;
+    ChunkStage neighbourStage; // Only if needsNeighbours
+};
+
+constexpr StagePrerequisites STAGE_PREREQUISITES[CHUNK_STAGE_COUNT] = {
+    {false, ChunkStage::Allocated}, // Allocated, never scheduled
+    {false, ChunkStage::Allocated}, // Terrain
+    {false, ChunkStage::Allocated}, // Decorated, decorations stay inside the chunk
+    {true, ChunkStage::Decorated},  // Meshed, reads the neighbours' border columns
+    {false, ChunkStage::Allocated}  // Uploaded, done by the main thread and not scheduled
+};
+
+// Every pipeline job is queued at this priority. A job doesn't run the stage it was queued for but the first waiting
+// one, so the order comes from the pending list alone and a priority per stage would mean nothing.
+constexpr JobPriority PIPELINE_JOB_PRIORITY = JobPriority::Normal;
+
+// Moves chunks around the player through Allocated -> Terrain -> Decorated -> Meshed -> Uploaded. Every step up
+// to Meshed is a job on the job system, queued by update() once the chunk and its neighbours are far enough along.
+// update() only allocates empty chunks and queues jobs, so the calling thread never waits for generation.
+// Queued stages wait in the pipeline rather than in the job system. Each job takes whichever waiting stage is
+// nearest to the camera when it starts, counting chunks out of view as further away and preferring the later stage
+// between equally near ones, so started chunks get finished before new ones begin. update() ranks them anew
+// for where the player is now. So after the player moves, the chunks in front of them are next instead of whatever
+// was queued first, without workers idling between updates. Stages of chunks that are further than keepDistance
+// chunks from the focus anchor by then are dropped without running, those chunks are about to be unloaded.
+// Blocks are final once a chunk is Decorated, which is what lets a mesh job read its neighbours without a lock.
+// Jobs hold on to the chunks they use, so those stay valid even if they are unloaded meanwhile.
+// With a world store, the Terrain job first tries to load the chunk and a chunk that was saved before goes straight
+// to Decorated; generated chunks are marked dirty once decorated. Without one chunks are never dirty, so unloading
+// them saves nothing.
+class ChunkPipeline {
+public:
+    ChunkPipeline(ChunkMap& chunks, std::mutex& chunksMutex, JobSystem& jobs, int keepDistance, WorldStore* store = nullptr)
+        : chunks(chunks), chunksMutex(chunksMutex), jobs(jobs), store(store), keepDistance(keepDistance) {}
+
+    // Chunks within renderDistance of the camera's chunk or of the predicted one are taken all the way to Meshed,
+    // the ring one chunk further out only to Decorated so the inner chunks can be meshed against it. camera is in
+    // blocks, frustum may be null to go by distance alone.
+    void update(const ChunkFocus& focus, int renderDistance, MeshingMode mode, glm::vec3 camera, const Frustum* frustum = nullptr) {
+        const int loadDistance = renderDistance + 1;
+        std::lock_guard<std::mutex> lock(chunksMutex);
+        if (!startedAt) {
+            startedAt = Clock::now();
+        }
+        std::shared_ptr<const ChunkMap::Entries> snapshot = chunks.snapshot();
+        bool missing = false;
+        forEachAround(focus, loadDistance, [&](int x, int z) {
+            missing = missing || !snapshot->contains({x, z});
+        });
+        if (missing) {
+            // Only publish a new version of the map when the player reached new chunks
+            chunks.update([&](ChunkMap::Writer& writer) {
+                forEachAround(focus, loadDistance, [&](int x, int z) {
+                    writer.tryEmplace({x, z}, x, z);
+                });
+            });
+            snapshot = chunks.snapshot();
+        }
+        // Drop what went out of range, rank the rest for where the player is now
+        for (std::size_t i = 0; i < pending.size();) {
+            PendingStage& stage = pending[i];
+            if (!within(stage.x, stage.z, focus.anchor, keepDistance)) {
+                drop(stage);
+                std::swap(stage, pending.back());
+                pending.pop_back();
+                continue;
+            }
+            stage.priority = priorityOf(stage.x, stage.z, camera, frustum);
+            ++i;
+        }
+
+        forEachAround(focus, loadDistance, [&](int x, int z) {
+            const std::shared_ptr<Chunk>& chunk = snapshot->at({x, z});
+            if (chunk->stageJobQueued || chunk->stage >= ChunkStage::Meshed) {
+                return;
+            }
+            const auto next = static_cast<ChunkStage>(static_cast<int>(chunk->stage.load()) + 1);
+            const bool inRenderDistance = within(x, z, focus.current, renderDistance) || within(x, z, focus.predicted, renderDistance);
+            if (next == ChunkStage::Meshed && !inRenderDistance) {
+                return;
+            }
+            std::array<std::shared_ptr<Chunk>, 4> neighbours{}; // +X, -X, +Z, -Z
+            if (STAGE_PREREQUISITES[static_cast<int>(next)].needsNeighbours &&
+                !findNeighbours(*snapshot, x, z, STAGE_PREREQUISITES[static_cast<int>(next)].neighbourStage, neighbours)) {
+                return;
+            }
+            schedule({priorityOf(x, z, camera, frustum), x, z, chunk, next, neighbours, mode, Clock::now()});
+        });
+    }
+
+    // Drops every pending stage and waits until the jobs queued for them have returned, for a pipeline that goes
+    // away before the job system does
+    void drain() {
+        std::unique_lock<std::mutex> lock(chunksMutex);
+        for (const PendingStage& stage : pending) {
+            drop(stage);
+        }
+        pending.clear();
+        jobsReturned.wait(lock, [this] { return jobsQueued == 0; });
+    }
+
+    // Meshes finished since the last call
+    std::vector<ChunkMesh> takeMeshes() {
+        std::lock_guard<std::mutex> lock(meshesMutex);
+        std::vector<ChunkMesh> result;
+        result.swap(meshes);
+        return result;
+    }
+
+    // For the main thread once a mesh from takeMeshes() is in the vertex heap, inView if the chunk is in the
+    // frustum it is drawn with. With the chunk map mutex held, cleanup may call markUnmeshed() on the same chunk.
+    void markUploaded(Chunk& chunk, const ChunkMesh& mesh, double uploadMilliseconds, bool inView) {
+        const Clock::time_point now = Clock::now();
+        const std::optional<Clock::time_point> waitingSince = chunk.waitingSince;
+        chunk.waitingSince.reset();
+        chunk.stage = ChunkStage::Uploaded;
+        const double latency = std::chrono::duration<double, std::milli>(now - mesh.meshedAt).count();
+        std::lock_guard<std::mutex> lock(statsMutex);
+        record(stageStats[static_cast<int>(ChunkStage::Uploaded)], uploadMilliseconds, latency);
+        if (inView && waitingSince) {
+            const double wait = std::chrono::duration<double, std::milli>(now - *waitingSince).count();
+            if (geometryStats.chunks == 0) {
+                geometryStats.spawnMilliseconds = std::chrono::duration<double, std::milli>(now - *startedAt).count();
+            }
+            geometryStats.chunks++;
+            geometryStats.lastMilliseconds = wait;
+            geometryStats.totalMilliseconds += wait;
+            geometryStats.maxMilliseconds = std::max(geometryStats.maxMilliseconds, wait);
+        }
+    }
+
+    // For a chunk that stays loaded but whose mesh was dropped or whose slice was freed: takes it back to Decorated,
+    // so update() meshes it again once it is in render distance. Only for chunks at Meshed or Uploaded, which no job
+    // touches, with the chunk map mutex held.
+    void markUnmeshed(Chunk& chunk) {
+        chunk.waitingSince = Clock::now();
+        chunk.stage = ChunkStage::Decorated;
+    }
+
+    std::array<ChunkStageStats, CHUNK_STAGE_COUNT> stats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        return stageStats;
+    }
+
+    FirstGeometryStats firstGeometryStats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        return geometryStats;
+    }
+
+private:
+    ChunkMap& chunks;
+    std::mutex& chunksMutex;
+    JobSystem& jobs;
+    WorldStore* store;
+    std::mutex meshesMutex;
+    std::vector<ChunkMesh> meshes;
+    std::mutex statsMutex;
+    std::array<ChunkStageStats, CHUNK_STAGE_COUNT> stageStats{};
+    FirstGeometryStats geometryStats;
+
+    using Clock = std::chrono::steady_clock;
+
+    // A stage queued by update() that no job has taken yet. Holds on to the chunk and its neighbours like the job
+    // that runs it will.
+    struct PendingStage {
+        float priority; // Lowest runs first
+        int x, z;
+        std::shared_ptr<Chunk> chunk;
+        ChunkStage next;
+        std::array<std::shared_ptr<Chunk>, 4> neighbours; // +X, -X, +Z, -Z, only for stages that read them
+        MeshingMode mode;
+        Clock::time_point queuedAt;
+    };
+
+    int keepDistance;
+    // Guarded by the chunk map mutex
+    std::vector<PendingStage> pending;
+    std::size_t jobsQueued = 0; // Dispatched runNext() jobs that haven't returned yet
+    std::condition_variable jobsReturned;
+    std::optional<Clock::time_point> startedAt; // The first update(), only read after it
+
+    static bool within(int x, int z, ChunkPosition center, int distance) {
+        return std::abs(x - center.first) <= distance && std::abs(z - center.second) <= distance;
+    }
+
+    // fn(x, z) once for every chunk within distance of the current or the predicted chunk
+    template <typename Fn>
+    static void forEachAround(const ChunkFocus& focus, int distance, Fn&& fn) {
+        const int minX = std::min(focus.current.first, focus.predicted.first) - distance;
+        const int maxX = std::max(focus.current.first, focus.predicted.first) + distance;
+        const int minZ = std::min(focus.current.second, focus.predicted.second) - distance;
+        const int maxZ = std::max(focus.current.second, focus.predicted.second) + distance;
+        for (int x = minX; x <= maxX; x++) {
+            for (int z = minZ; z <= maxZ; z++) {
+                if (within(x, z, focus.current, distance) || within(x, z, focus.predicted, distance)) {
+                    fn(x, z);
+                }
+            }
+        }
+    }
+
+    // Squared horizontal distance from the camera to the middle of the chunk, as if further when out of view
+    static float priorityOf(int x, int z, glm::vec3 camera, const Frustum* frustum) {
+        const glm::vec3 origin(x * CHUNK_SIZE_X - 0.5f, -0.5f, z * CHUNK_SIZE_Z - 0.5f);
+        const glm::vec3 size(CHUNK_SIZE_X, CHUNK_SIZE_Y, CHUNK_SIZE_Z);
+        const glm::vec2 offset = glm::vec2(origin.x + size.x * 0.5f - camera.x, origin.z + size.z * 0.5f - camera.z);
+        const float distance = glm::dot(offset, offset);
+        if (frustum && !frustum->intersects(origin, origin + size)) {
+            return distance * OUT_OF_VIEW_DISTANCE_FACTOR * OUT_OF_VIEW_DISTANCE_FACTOR;
+        }
+        return distance;
+    }
+
+    static void record(ChunkStageStats& stats, double runMilliseconds, double latencyMilliseconds) {
+        stats.completed++;
+        stats.totalRunMilliseconds += runMilliseconds;
+        stats.totalLatencyMilliseconds += latencyMilliseconds;
+        stats.maxLatencyMilliseconds = std::max(stats.maxLatencyMilliseconds, latencyMilliseconds);
+    }
+
+    static bool findNeighbours(const ChunkMap::Entries& snapshot, int x, int z, ChunkStage minimumStage,
+                               std::array<std::shared_ptr<Chunk>, 4>& neighbours) {
+        const std::pair<int, int> positions[4] = {{x + 1, z}, {x - 1, z}, {x, z + 1}, {x, z - 1}};
+        for (int i = 0; i < 4; i++) {
+            auto it = snapshot.find(positions[i]);
+            if (it == snapshot.end() || it->second->stage < minimumStage) {
+                return false;
+            }
+            neighbours[i] = it->second;
+        }
+        return true;
+    }
+
+    // Called with the chunk map mutex held, once the stage has run or been dropped
+    static void release(const PendingStage& stage) {
+        stage.chunk->stageJobQueued = false;
+        stage.chunk->jobRefs--;
+        for (const std::shared_ptr<Chunk>& neighbour : stage.neighbours) {
+            if (neighbour) neighbour->jobRefs--;
+        }
+    }
+
+    // Called with the chunk map mutex held, for a stage that is dropped without running
+    void drop(const PendingStage& stage) {
+        release(stage);
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stageStats[static_cast<int>(stage.next)].inFlight--;
+        stageStats[static_cast<int>(stage.next)].cancelled++;
+    }
+
+    // Called with the chunk map mutex held. The pending stage keeps the chunk and its neighbours alive, jobRefs keeps
+    // cleanup from unloading them meanwhile so the work isn't thrown away. Every queued stage gets a job of its own,
+    // but that job runs whichever stage is first by then, see PIPELINE_JOB_PRIORITY.
+    void schedule(PendingStage stage) {
+        stage.chunk->stageJobQueued = true;
+        stage.chunk->jobRefs++;
+        for (const std::shared_ptr<Chunk>& neighbour : stage.neighbours) {
+            if (neighbour) neighbour->jobRefs++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stageStats[static_cast<int>(stage.next)].inFlight++;
+        }
+        pending.push_back(std::move(stage));
+        jobsQueued++;
+        jobs.dispatch([this]() { runNext(); }, PIPELINE_JOB_PRIORITY);
+    }
+
+    void runNext() {
+        PendingStage stage;
+        {
+            std::lock_guard<std::mutex> lock(chunksMutex);
+            if (pending.empty()) {
+                jobsQueued--; // Its stage was dropped
+                jobsReturned.notify_all();
+                return;
+            }
+            auto first = std::min_element(pending.begin(), pending.end(), [](const PendingStage& a, const PendingStage& b) {
+                return a.priority < b.priority || (a.priority == b.priority && a.next > b.next);
+            });
+            std::swap(*first, pending.back());
+            stage = std::move(pending.back());
+            pending.pop_back();
+        }
+        const auto& [priority, x, z, chunk, next, neighbours, mode, queuedAt] = stage;
+
+        const Clock::time_point start = Clock::now();
+        ChunkStage reached = next;
+        std::array<std::uint32_t, SECTIONS_PER_CHUNK + 1> sections{};
+        std::array<SectionConnectivity, SECTIONS_PER_CHUNK> connectivity{};
+        switch (next) {
+            case ChunkStage::Terrain:
+                if (store && store->load(x, z, [chunk](const std::uint8_t* data, std::size_t size) { return chunk->deserialize(data, size); })) {
+                    reached = ChunkStage::Decorated;
+                } else {
+                    chunk->generateTerrain(x, z);
+                }
+                break;
+            case ChunkStage::Decorated:
+                chunk->decorate();
+                break;
+            default:
+                chunk->generateChunkData(x, z, neighbours[0].get(), neighbours[1].get(), neighbours[2].get(), neighbours[3].get(), mode);
+                sections = groupFacesBySection(chunk->combinedData);
+                for (int s = 0; s < SECTIONS_PER_CHUNK; ++s) {
+                    connectivity[s] = chunk->sectionConnectivity(s);
+                }
+                break;
+        }
+        const Clock::time_point end = Clock::now();
+
+        std::lock_guard<std::mutex> lock(chunksMutex);
+        chunk->stage = reached;
+        if (next == ChunkStage::Decorated && store) {
+            chunk->dirty = true; // Generated, not loaded, so not in the world store yet
+        }
+        release(stage);
+        if (next == ChunkStage::Meshed) {
+            // The faces live in the vertex heap from here on, the chunk keeps no copy
+            std::lock_guard<std::mutex> meshesLock(meshesMutex);
+            meshes.push_back({x, z, ChunkMap::handle(*chunk), std::move(chunk->combinedData), sections, connectivity, end});
+        }
+        {
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            ChunkStageStats& stats = stageStats[static_cast<int>(next)];
+            stats.inFlight--;
+            record(stats, std::chrono::duration<double, std::milli>(end - start).count(),
+                   std::chrono::duration<double, std::milli>(end - queuedAt).count());
+        }
+        // Last, drain() may destroy the pipeline as soon as the chunk map mutex is released
+        jobsQueued--;
+        jobsReturned.notify_all();
+    }
+};
+
+#endif // CHUNK_PIPELINE_H
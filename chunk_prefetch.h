@@ -0,0 +1,80 @@
+#ifndef CHUNK_PREFETCH_H
+#define CHUNK_PREFETCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <glm/glm.hpp>
+#include "chunk.h"
+#include "chunk_index.h"
+
+// Velocity samples are averaged over roughly this long, so a single long frame or a twitch of the mouse doesn't
+// swing the prediction around
+constexpr float VELOCITY_SMOOTHING_SECONDS = 0.25f;
+
+// The chunks the load pipeline works towards in one frame
+struct ChunkFocus {
+    ChunkPosition current{0, 0};   // The camera's chunk
+    ChunkPosition predicted{0, 0}; // Where the camera is heading, loaded and meshed ahead of time
+    ChunkPosition anchor{0, 0};    // Centre of the square of chunks that stays loaded, trails current
+};
+
+// Guesses where the camera is going from how it moved over the last frames. The predicted chunk is where the smoothed
+// velocity leads in lookaheadSeconds, at most aheadChunks from the current chunk on either axis, so flying fast gets
+// the chunks in front started before the camera crosses into them. The anchor only follows the camera once it is more
+// than slackChunks chunks away, so going back and forth over a chunk border loads and unloads nothing. Whatever keeps
+// chunks around the anchor has to reach the load distance plus aheadChunks plus slackChunks.
+class ChunkPrefetch {
+public:
+    ChunkPrefetch(int aheadChunks, int slackChunks, float lookaheadSeconds)
+        : aheadChunks(aheadChunks), slackChunks(slackChunks), lookaheadSeconds(lookaheadSeconds) {}
+
+    // Once per frame, seconds from any clock that only goes forward
+    void update(glm::vec3 position, double seconds) {
+        if (lastSeconds && seconds > *lastSeconds) {
+            const auto elapsed = static_cast<float>(seconds - *lastSeconds);
+            const glm::vec3 sample = (position - lastPosition) / elapsed;
+            smoothedVelocity += (sample - smoothedVelocity) * (1.0f - std::exp(-elapsed / VELOCITY_SMOOTHING_SECONDS));
+        }
+        lastSeconds = seconds;
+        lastPosition = position;
+
+        const ChunkPosition current = chunkOf(position);
+        const glm::vec3 ahead = position + smoothedVelocity * lookaheadSeconds;
+        const ChunkPosition heading = chunkOf(ahead);
+        chunkFocus.current = current;
+        chunkFocus.predicted = {std::clamp(heading.first, current.first - aheadChunks, current.first + aheadChunks),
+                                std::clamp(heading.second, current.second - aheadChunks, current.second + aheadChunks)};
+        if (!anchored) {
+            chunkFocus.anchor = current;
+            anchored = true;
+        }
+        chunkFocus.anchor = {std::clamp(chunkFocus.anchor.first, current.first - slackChunks, current.first + slackChunks),
+                             std::clamp(chunkFocus.anchor.second, current.second - slackChunks, current.second + slackChunks)};
+    }
+
+    const ChunkFocus& focus() const {
+        return chunkFocus;
+    }
+
+    // Blocks per second
+    glm::vec3 velocity() const {
+        return smoothedVelocity;
+    }
+
+private:
+    int aheadChunks;
+    int slackChunks;
+    float lookaheadSeconds;
+    std::optional<double> lastSeconds;
+    glm::vec3 lastPosition{0.0f};
+    glm::vec3 smoothedVelocity{0.0f};
+    ChunkFocus chunkFocus;
+    bool anchored = false;
+
+    static ChunkPosition chunkOf(glm::vec3 position) {
+        return {static_cast<int>(std::floor(position.x / CHUNK_SIZE_X)), static_cast<int>(std::floor(position.z / CHUNK_SIZE_Z))};
+    }
+};
+
+#endif // CHUNK_PREFETCH_H
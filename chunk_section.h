@@ -0,0 +1,189 @@
+#ifndef CHUNK_SECTION_H
+#define CHUNK_SECTION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "chunk_storage.h"
+#include "palette_storage.h"
+
+constexpr int SECTION_SIZE = 16;
+
+// How non-uniform sections keep their voxels: a flat BlockID per voxel (8 KiB), or palette indices packed
+// at 1-16 bits per voxel (typically 1-2 KiB for terrain)
+enum class SectionStorageMode {
+    Flat,
+    Palette
+};
+constexpr SectionStorageMode SECTION_STORAGE_MODE = SectionStorageMode::Palette;
+
+// A 16x16x16 slice of a chunk. While every voxel holds the same block the section is stored as that single
+// id and no voxel array exists at all, the array is only allocated by the first set() that breaks uniformity.
+class ChunkSection {
+public:
+    using Storage = std::conditional_t<SECTION_STORAGE_MODE == SectionStorageMode::Palette,
+                                       PaletteStorage<SECTION_SIZE, SECTION_SIZE, SECTION_SIZE>,
+                                       ChunkStorage<SECTION_SIZE, SECTION_SIZE, SECTION_SIZE>>;
+
+    ChunkSection() = default;
+
+    bool isUniform() const {
+        return storage == nullptr;
+    }
+
+    bool isEmpty() const {
+        return isUniform() && uniformBlock == BlockIds::AIR;
+    }
+
+    // Only meaningful while isUniform() is true
+    BlockID uniformId() const {
+        return uniformBlock;
+    }
+
+    BlockID get(int x, int y, int z) const {
+        return storage ? storage->get(x, y, z) : uniformBlock;
+    }
+
+    void set(int x, int y, int z, BlockID id) {
+        if (!storage) {
+            if (id == uniformBlock) return;
+            storage = std::make_unique<Storage>();
+            storage->fill(uniformBlock);
+        }
+        storage->set(x, y, z, id);
+    }
+
+    void fill(BlockID id) {
+        storage.reset();
+        uniformBlock = id;
+    }
+
+    // Drops the voxel array again if every voxel ended up being the same block, otherwise lets the storage shrink
+    void compact() {
+        if (!storage) return;
+        BlockID id;
+        if (storage->isUniform(id)) {
+            fill(id);
+        } else {
+            storage->compact();
+        }
+    }
+
+    // Decodes the whole section in Storage::index order into out[0..Storage::VOLUME)
+    void unpack(BlockID* out) const {
+        if (storage) {
+            storage->unpack(out);
+        } else {
+            std::fill(out, out + Storage::VOLUME, uniformBlock);
+        }
+    }
+
+    std::size_t memoryUsage() const {
+        return sizeof(*this) + (storage ? storage->memoryUsage() : 0);
+    }
+
+    // Appends the section in the saved format: a uniform section as UNIFORM_TAG and its id, any other one as log2 of
+    // its index width, palette length, palette and packed index words in Packed::index order. Values are written in
+    // host byte order, which is little endian on every platform this builds for.
+    void serialize(std::vector<std::uint8_t>& out) const {
+        if (!storage) {
+            out.push_back(UNIFORM_TAG);
+            append(out, uniformBlock);
+            return;
+        }
+        if constexpr (std::is_same_v<Storage, Packed>) {
+            appendPacked(out, *storage);
+        } else {
+            // Flat storage is packed on the way out, so saved sections look the same in both modes
+            Packed packed;
+            copyVoxels(*storage, packed);
+            packed.compact();
+            appendPacked(out, packed);
+        }
+    }
+
+    // Reads a section written by serialize() from [in, end) and moves in past it, false if the data is malformed
+    bool deserialize(const std::uint8_t*& in, const std::uint8_t* end) {
+        std::uint8_t tag;
+        if (!read(in, end, tag)) return false;
+        if (tag == UNIFORM_TAG) {
+            BlockID id;
+            if (!read(in, end, id) || id >= BLOCK_COUNT) return false;
+            fill(id);
+            return true;
+        }
+
+        std::uint16_t paletteSize;
+        if (!read(in, end, paletteSize) || static_cast<std::size_t>(end - in) < paletteSize * sizeof(BlockID)) return false;
+        std::vector<BlockID> palette(paletteSize);
+        std::memcpy(palette.data(), in, paletteSize * sizeof(BlockID));
+        in += paletteSize * sizeof(BlockID);
+        if (std::any_of(palette.begin(), palette.end(), [](BlockID id) { return id >= BLOCK_COUNT; })) return false;
+
+        const std::size_t wordCount = tag <= 4 ? static_cast<std::size_t>(Packed::VOLUME) * (1 << tag) / 64 : 0;
+        if (static_cast<std::size_t>(end - in) < wordCount * sizeof(std::uint64_t)) return false;
+        std::vector<std::uint64_t> words(wordCount);
+        std::memcpy(words.data(), in, wordCount * sizeof(std::uint64_t));
+        auto packed = std::make_unique<Packed>();
+        if (!packed->assignPacked(tag, std::move(palette), words.data())) return false;
+        in += wordCount * sizeof(std::uint64_t);
+
+        if constexpr (std::is_same_v<Storage, Packed>) {
+            storage = std::move(packed);
+        } else {
+            storage = std::make_unique<Storage>();
+            copyVoxels(*packed, *storage);
+        }
+        return true;
+    }
+
+private:
+    using Packed = PaletteStorage<SECTION_SIZE, SECTION_SIZE, SECTION_SIZE, Storage::LAYOUT>;
+    static constexpr std::uint8_t UNIFORM_TAG = 0xFF;
+
+    template <typename T>
+    static void append(std::vector<std::uint8_t>& out, T value) {
+        const std::size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    static bool read(const std::uint8_t*& in, const std::uint8_t* end, T& value) {
+        if (static_cast<std::size_t>(end - in) < sizeof(T)) return false;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return true;
+    }
+
+    static void appendPacked(std::vector<std::uint8_t>& out, const Packed& packed) {
+        const std::vector<BlockID>& palette = packed.packedPalette();
+        const std::vector<std::uint64_t>& words = packed.packedWords();
+        out.push_back(static_cast<std::uint8_t>(packed.packedBitsLog2()));
+        append(out, static_cast<std::uint16_t>(palette.size()));
+        const std::size_t at = out.size();
+        out.resize(at + palette.size() * sizeof(BlockID) + words.size() * sizeof(std::uint64_t));
+        std::memcpy(out.data() + at, palette.data(), palette.size() * sizeof(BlockID));
+        std::memcpy(out.data() + at + palette.size() * sizeof(BlockID), words.data(), words.size() * sizeof(std::uint64_t));
+    }
+
+    template <typename From, typename To>
+    static void copyVoxels(const From& from, To& to) {
+        for (int x = 0; x < SECTION_SIZE; ++x) {
+            for (int y = 0; y < SECTION_SIZE; ++y) {
+                for (int z = 0; z < SECTION_SIZE; ++z) {
+                    to.set(x, y, z, from.get(x, y, z));
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<Storage> storage;
+    BlockID uniformBlock = BlockIds::AIR;
+};
+
+#endif // CHUNK_SECTION_H
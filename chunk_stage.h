@@ -0,0 +1,59 @@
+#ifndef CHUNK_STAGE_H
+#define CHUNK_STAGE_H
+
+#include <cstddef>
+
+// How far a chunk has come through the load pipeline, see chunk_pipeline.h. Every stage implies all earlier ones.
+enum class ChunkStage {
+    Allocated, // Exists in the chunk map, no blocks yet
+    Terrain,   // Height map, layers, water and caves
+    Decorated, // Trees and cacti, the blocks are final from here on
+    Meshed,    // Faces built, waiting for the main thread
+    Uploaded   // Faces are in the vertex heap and drawn
+};
+constexpr int CHUNK_STAGE_COUNT = 5;
+
+constexpr const char* chunkStageName(ChunkStage stage) {
+    switch (stage) {
+        case ChunkStage::Allocated: return "Allocated";
+        case ChunkStage::Terrain: return "Terrain";
+        case ChunkStage::Decorated: return "Decorated";
+        case ChunkStage::Meshed: return "Meshed";
+        default: return "Uploaded";
+    }
+}
+
+// Work done to bring chunks into one stage. Latency runs from scheduling to completion, so it includes the time
+// the job waited in the queue, run time is only the job itself.
+struct ChunkStageStats {
+    std::size_t completed = 0;
+    std::size_t inFlight = 0;  // Scheduled, not completed yet
+    std::size_t cancelled = 0; // Dropped before they started, the chunk had gone out of range
+    double totalRunMilliseconds = 0.0;
+    double totalLatencyMilliseconds = 0.0;
+    double maxLatencyMilliseconds = 0.0;
+
+    double averageRunMilliseconds() const {
+        return completed == 0 ? 0.0 : totalRunMilliseconds / static_cast<double>(completed);
+    }
+
+    double averageLatencyMilliseconds() const {
+        return completed == 0 ? 0.0 : totalLatencyMilliseconds / static_cast<double>(completed);
+    }
+};
+
+// How long the player waited for chunks in view to show up, from when the chunk was allocated, or taken back to
+// be meshed again, until its faces were uploaded while it was in the frustum
+struct FirstGeometryStats {
+    double spawnMilliseconds = 0.0; // From the first pipeline update until the first chunk in view had faces
+    std::size_t chunks = 0;
+    double lastMilliseconds = 0.0;
+    double totalMilliseconds = 0.0;
+    double maxMilliseconds = 0.0;
+
+    double averageMilliseconds() const {
+        return chunks == 0 ? 0.0 : totalMilliseconds / static_cast<double>(chunks);
+    }
+};
+
+#endif // CHUNK_STAGE_H
@@ -0,0 +1,75 @@
+#ifndef CHUNK_STORAGE_H
+#define CHUNK_STORAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "block.cpp"
+
+// Order in which the three coordinates are flattened into the id array, the last letter moves fastest
+enum class ChunkLayout {
+    XYZ, // z fastest, same order the old nested vectors used
+    XZY, // y fastest, every column is contiguous
+    YZX  // x fastest, every horizontal row is contiguous
+};
+
+// Flat, contiguous block storage: one BlockID per voxel, properties are looked up in BLOCK_REGISTRY.
+// The index layout is a template parameter so it is fixed at compile time and index() folds to a few multiplies.
+template <int SizeX, int SizeY, int SizeZ, ChunkLayout Layout = ChunkLayout::XZY>
+class ChunkStorage {
+public:
+    static constexpr int VOLUME = SizeX * SizeY * SizeZ;
+    static constexpr ChunkLayout LAYOUT = Layout;
+
+    ChunkStorage() : ids(VOLUME, BlockIds::AIR) {}
+
+    static constexpr int index(int x, int y, int z) {
+        if constexpr (Layout == ChunkLayout::XYZ) {
+            return (x * SizeY + y) * SizeZ + z;
+        } else if constexpr (Layout == ChunkLayout::XZY) {
+            return (x * SizeZ + z) * SizeY + y;
+        } else {
+            return (y * SizeZ + z) * SizeX + x;
+        }
+    }
+
+    BlockID get(int x, int y, int z) const {
+        return ids[index(x, y, z)];
+    }
+
+    void set(int x, int y, int z, BlockID id) {
+        ids[index(x, y, z)] = id;
+    }
+
+    void fill(BlockID id) {
+        std::fill(ids.begin(), ids.end(), id);
+    }
+
+    const BlockID* data() const {
+        return ids.data();
+    }
+
+    // Copies every voxel in storage order into out[0..VOLUME)
+    void unpack(BlockID* out) const {
+        std::copy(ids.begin(), ids.end(), out);
+    }
+
+    // True if every voxel holds the same block, which is written to id
+    bool isUniform(BlockID& id) const {
+        id = ids.front();
+        return std::all_of(ids.begin(), ids.end(), [id](BlockID other) { return other == id; });
+    }
+
+    // Nothing to shrink in the flat layout, present so both section storages share one interface
+    void compact() {}
+
+    // Bytes held by this storage, used for memory statistics
+    std::size_t memoryUsage() const {
+        return sizeof(*this) + ids.capacity() * sizeof(BlockID);
+    }
+
+private:
+    std::vector<BlockID> ids;
+};
+
+#endif // CHUNK_STORAGE_H
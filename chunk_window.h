@@ -0,0 +1,158 @@
+#ifndef CHUNK_WINDOW_H
+#define CHUNK_WINDOW_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "chunk_index.h"
+
+// The square of chunks within radius of a centre chunk, in a fixed grid of (2 * radius + 1)^2 cells that wraps
+// around: chunk (x, z) always lives in cell (x mod side, z mod side). Finding a chunk or its neighbours is
+// arithmetic, and moving the centre only touches the rows and columns that scroll out, which are handed to the
+// caller and emptied, so a border crossing costs O(radius) instead of a pass over everything loaded.
+template <typename T>
+class ChunkWindow {
+public:
+    explicit ChunkWindow(int radius) : windowRadius(radius), side(2 * radius + 1), cells(static_cast<std::size_t>(side * side)) {
+        // Offsets from the centre, nearest first, for forEachNearestFirst()
+        for (int dx = -radius; dx <= radius; ++dx) {
+            for (int dz = -radius; dz <= radius; ++dz) {
+                offsets.emplace_back(dx, dz);
+            }
+        }
+        std::stable_sort(offsets.begin(), offsets.end(), [](ChunkPosition a, ChunkPosition b) {
+            return a.first * a.first + a.second * a.second < b.first * b.first + b.second * b.second;
+        });
+    }
+
+    int radius() const {
+        return windowRadius;
+    }
+
+    ChunkPosition center() const {
+        return centre;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    bool contains(int x, int z) const {
+        return std::abs(x - centre.first) <= windowRadius && std::abs(z - centre.second) <= windowRadius;
+    }
+
+    // Null if (x, z) is outside the window or has nothing in it
+    T* find(int x, int z) {
+        if (!contains(x, z)) return nullptr;
+        Cell& cell = cellAt(x, z);
+        return cell.occupied ? &cell.value : nullptr;
+    }
+
+    const T* find(int x, int z) const {
+        return const_cast<ChunkWindow*>(this)->find(x, z);
+    }
+
+    // The value at (x, z), default constructed if there was none. (x, z) has to be inside the window.
+    T& emplace(int x, int z) {
+        Cell& cell = cellAt(x, z);
+        if (!cell.occupied) {
+            cell.occupied = true;
+            cell.value = T();
+            count++;
+        }
+        return cell.value;
+    }
+
+    // Empties (x, z), returns whether there was anything to take out
+    bool erase(int x, int z) {
+        if (!contains(x, z)) return false;
+        Cell& cell = cellAt(x, z);
+        if (!cell.occupied) return false;
+        cell.occupied = false;
+        cell.value = T();
+        count--;
+        return true;
+    }
+
+    // Moves the window to be centred on (x, z). Every position that ends up outside goes to evict(position, value)
+    // before its cell is emptied, value being null if nothing was stored for it. Cells that scroll in start out empty.
+    template <typename Evict>
+    void recenter(int x, int z, Evict&& evict) {
+        const ChunkPosition old = centre;
+        centre = {x, z};
+        if (old == centre) return;
+        if (std::abs(x - old.first) >= side || std::abs(z - old.second) >= side) {
+            // Nothing overlaps, every cell scrolls out
+            for (int cx = old.first - windowRadius; cx <= old.first + windowRadius; ++cx) {
+                for (int cz = old.second - windowRadius; cz <= old.second + windowRadius; ++cz) {
+                    evictCell(cx, cz, evict);
+                }
+            }
+            return;
+        }
+        // Columns that left over their whole old extent, columns that stayed only below and above the new extent
+        for (int cx = old.first - windowRadius; cx <= old.first + windowRadius; ++cx) {
+            if (std::abs(cx - x) > windowRadius) {
+                for (int cz = old.second - windowRadius; cz <= old.second + windowRadius; ++cz) {
+                    evictCell(cx, cz, evict);
+                }
+                continue;
+            }
+            for (int cz = old.second - windowRadius; cz < z - windowRadius; ++cz) {
+                evictCell(cx, cz, evict);
+            }
+            for (int cz = z + windowRadius + 1; cz <= old.second + windowRadius; ++cz) {
+                evictCell(cx, cz, evict);
+            }
+        }
+    }
+
+    // fn(position, value) for every chunk in the window, by distance from the centre
+    template <typename Fn>
+    void forEachNearestFirst(Fn&& fn) {
+        for (const auto& [dx, dz] : offsets) {
+            const int x = centre.first + dx;
+            const int z = centre.second + dz;
+            Cell& cell = cellAt(x, z);
+            if (cell.occupied) {
+                fn(ChunkPosition(x, z), cell.value);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        T value{};
+        bool occupied = false;
+    };
+
+    int windowRadius;
+    int side;
+    ChunkPosition centre{0, 0};
+    std::vector<Cell> cells;
+    std::vector<ChunkPosition> offsets;
+    std::size_t count = 0;
+
+    Cell& cellAt(int x, int z) {
+        const int cx = (x % side + side) % side;
+        const int cz = (z % side + side) % side;
+        return cells[static_cast<std::size_t>(cx * side + cz)];
+    }
+
+    template <typename Evict>
+    void evictCell(int x, int z, Evict& evict) {
+        Cell& cell = cellAt(x, z);
+        if (!cell.occupied) {
+            evict(ChunkPosition(x, z), static_cast<T*>(nullptr));
+            return;
+        }
+        evict(ChunkPosition(x, z), &cell.value);
+        cell.occupied = false;
+        cell.value = T();
+        count--;
+    }
+};
+
+#endif // CHUNK_WINDOW_H
@@ -0,0 +1,79 @@
+#ifndef DENSITY_LATTICE_H
+#define DENSITY_LATTICE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "FastNoiseLite.h"
+
+// Spacing in blocks of the points a 3D density field is actually sampled at, everything between is interpolated.
+// x and z have to divide the chunk size so lattice points sit on the same world positions in every chunk and
+// neighbouring chunks agree along their border. {1, 1, 1} samples every block.
+struct LatticeStep {
+    int x;
+    int y;
+    int z;
+};
+
+// A box of noise values sampled on a lattice and trilinearly interpolated, x fastest, then y, then z.
+// Noise is read at ((originX + x) * scaleX, y * scaleY, (originZ + z) * scaleZ) for block (x, y, z).
+class DensityLattice {
+public:
+    // Samples and interpolates sizeX * height * sizeZ values, returns the number of noise samples taken
+    std::size_t fill(const FastNoiseLite& noise, LatticeStep step, double originX, double originZ, int sizeX, int height, int sizeZ,
+                     double scaleX = 1.0, double scaleY = 1.0, double scaleZ = 1.0) {
+        this->sizeX = sizeX;
+        this->height = height;
+        values.resize(static_cast<std::size_t>(sizeX) * std::max(height, 0) * sizeZ);
+        if (height <= 0) {
+            return 0;
+        }
+
+        // One lattice point past the last block on x and z (the neighbour's first one), on y just enough to cover the top block
+        const int pointsX = sizeX / step.x + 1;
+        const int pointsY = (height - 1 + step.y - 1) / step.y + 1;
+        const int pointsZ = sizeZ / step.z + 1;
+        lattice.resize(static_cast<std::size_t>(pointsX) * pointsY * pointsZ);
+        noise.GenUniformGrid3D(lattice.data(), originX * scaleX, 0.0, originZ * scaleZ, pointsX, pointsY, pointsZ,
+                               step.x * scaleX, step.y * scaleY, step.z * scaleZ);
+
+        auto point = [&](int px, int py, int pz) { return lattice[(static_cast<std::size_t>(pz) * pointsY + py) * pointsX + px]; };
+        for (int z = 0; z < sizeZ; ++z) {
+            const int z0 = z / step.z;
+            const float tz = static_cast<float>(z % step.z) / step.z;
+            for (int y = 0; y < height; ++y) {
+                const int y0 = y / step.y;
+                const int y1 = std::min(y0 + 1, pointsY - 1);
+                const float ty = static_cast<float>(y % step.y) / step.y;
+                float* row = &values[(static_cast<std::size_t>(z) * height + y) * sizeX];
+                for (int x = 0; x < sizeX; ++x) {
+                    const int x0 = x / step.x;
+                    const float tx = static_cast<float>(x % step.x) / step.x;
+                    // With t == 0 every lerp returns its first value unchanged, so lattice points keep the exact noise value
+                    const float c00 = lerp(point(x0, y0, z0), point(x0 + 1, y0, z0), tx);
+                    const float c10 = lerp(point(x0, y1, z0), point(x0 + 1, y1, z0), tx);
+                    const float c01 = lerp(point(x0, y0, z0 + 1), point(x0 + 1, y0, z0 + 1), tx);
+                    const float c11 = lerp(point(x0, y1, z0 + 1), point(x0 + 1, y1, z0 + 1), tx);
+                    row[x] = lerp(lerp(c00, c10, ty), lerp(c01, c11, ty), tz);
+                }
+            }
+        }
+        return lattice.size();
+    }
+
+    float at(int x, int y, int z) const {
+        return values[(static_cast<std::size_t>(z) * height + y) * sizeX + x];
+    }
+
+private:
+    std::vector<float> lattice;
+    std::vector<float> values;
+    int sizeX = 0;
+    int height = 0;
+
+    static float lerp(float a, float b, float t) {
+        return a + t * (b - a);
+    }
+};
+
+#endif // DENSITY_LATTICE_H
@@ -0,0 +1,159 @@
+#ifndef FACE_CULLING_H
+#define FACE_CULLING_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "block.cpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FACE_CULLING_AVX2 1
+#include <immintrin.h>
+#endif
+
+// Binary face culling: every chunk column is a 128-bit mask (bit y = voxel at height y) and the visible faces of
+// all six directions fall out of shifts and AND-NOTs over whole columns instead of one neighbour test per voxel.
+
+constexpr int CULL_COLUMN_HEIGHT = 128;
+constexpr int CULL_CHUNK_WIDTH = 16;
+constexpr int CULL_PADDED_WIDTH = CULL_CHUNK_WIDTH + 2; // One border column on each side, taken from the neighbours
+
+struct ColumnMask {
+    std::uint64_t lo = 0; // y 0-63
+    std::uint64_t hi = 0; // y 64-127
+
+    bool test(int y) const {
+        return ((y < 64 ? lo >> y : hi >> (y - 64)) & 1) != 0;
+    }
+};
+static_assert(sizeof(ColumnMask) == 16, "Column masks are loaded as raw 128-bit lanes");
+
+// Every liquid block id, a face between two voxels of the same liquid is hidden
+constexpr int LIQUID_COUNT = std::popcount(LIQUID_BLOCKS);
+constexpr int LIQUID_SLOTS = LIQUID_COUNT > 0 ? LIQUID_COUNT : 1;
+constexpr std::array<BlockID, LIQUID_SLOTS> LIQUID_IDS = [] {
+    std::array<BlockID, LIQUID_SLOTS> ids{};
+    int count = 0;
+    for (std::size_t i = 0; i < BLOCK_COUNT; ++i) {
+        if (isLiquid(static_cast<BlockID>(i))) ids[count++] = static_cast<BlockID>(i);
+    }
+    return ids;
+}();
+
+struct FaceCullInput {
+    // Index with paddedIndex(), the chunk's own columns are 1..16 on both axes. Border columns of a missing
+    // neighbour stay zero, which makes them opaque, so no faces are produced towards unloaded chunks.
+    ColumnMask solid[CULL_PADDED_WIDTH * CULL_PADDED_WIDTH];       // Anything but air
+    ColumnMask transparent[CULL_PADDED_WIDTH * CULL_PADDED_WIDTH];
+    ColumnMask liquid[LIQUID_SLOTS][CULL_PADDED_WIDTH * CULL_PADDED_WIDTH]; // One mask per entry of LIQUID_IDS
+
+    static constexpr int paddedIndex(int px, int pz) {
+        return px * CULL_PADDED_WIDTH + pz;
+    }
+};
+
+struct FaceCullOutput {
+    // visible[face][x * 16 + z], faces in the FaceDirection order: -Z, +Z, -X, +X, +Y, -Y
+    ColumnMask visible[6][CULL_CHUNK_WIDTH * CULL_CHUNK_WIDTH];
+};
+
+// Padded-index distance to the horizontal neighbour each side face looks at
+constexpr int CULL_NEIGHBOUR_OFFSETS[4] = {-1, 1, -CULL_PADDED_WIDTH, CULL_PADDED_WIDTH};
+
+inline void cullFacesScalar(const FaceCullInput& in, FaceCullOutput& out) {
+    for (int x = 0; x < CULL_CHUNK_WIDTH; ++x) {
+        for (int z = 0; z < CULL_CHUNK_WIDTH; ++z) {
+            const int p = FaceCullInput::paddedIndex(x + 1, z + 1);
+            const int c = x * CULL_CHUNK_WIDTH + z;
+            const ColumnMask solid = in.solid[p];
+
+            for (int face = 0; face < 4; ++face) {
+                const int n = p + CULL_NEIGHBOUR_OFFSETS[face];
+                std::uint64_t hiddenLo = 0, hiddenHi = 0;
+                for (int k = 0; k < LIQUID_COUNT; ++k) {
+                    hiddenLo |= in.liquid[k][p].lo & in.liquid[k][n].lo;
+                    hiddenHi |= in.liquid[k][p].hi & in.liquid[k][n].hi;
+                }
+                out.visible[face][c] = {solid.lo & in.transparent[n].lo & ~hiddenLo, solid.hi & in.transparent[n].hi & ~hiddenHi};
+            }
+
+            // Above the column counts as air, and so does below it
+            const ColumnMask t = in.transparent[p];
+            ColumnMask up{t.lo >> 1 | t.hi << 63, t.hi >> 1 | std::uint64_t{1} << 63};
+            ColumnMask down{t.lo << 1 | 1, t.hi << 1 | t.lo >> 63};
+            for (int k = 0; k < LIQUID_COUNT; ++k) {
+                const ColumnMask l = in.liquid[k][p];
+                up.lo &= ~(l.lo & (l.lo >> 1 | l.hi << 63));
+                up.hi &= ~(l.hi & l.hi >> 1);
+                down.lo &= ~(l.lo & l.lo << 1);
+                down.hi &= ~(l.hi & (l.hi << 1 | l.lo >> 63));
+            }
+            out.visible[4][c] = {solid.lo & up.lo, solid.hi & up.hi};
+            out.visible[5][c] = {solid.lo & down.lo, solid.hi & down.hi};
+        }
+    }
+}
+
+#ifdef FACE_CULLING_AVX2
+// Same as cullFacesScalar, two neighbouring columns per 256-bit register. Byte shifts in AVX2 stay inside their
+// 128-bit lane, which is exactly one column, so carrying a bit from lo to hi needs no cross-lane shuffle.
+__attribute__((target("avx2"))) inline __m256i loadColumns(const ColumnMask* m) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m));
+}
+
+__attribute__((target("avx2"))) inline __m256i shiftColumnsUp(__m256i v) { // bit y <- bit y + 1
+    return _mm256_or_si256(_mm256_srli_epi64(v, 1), _mm256_srli_si256(_mm256_slli_epi64(v, 63), 8));
+}
+
+__attribute__((target("avx2"))) inline __m256i shiftColumnsDown(__m256i v) { // bit y <- bit y - 1
+    return _mm256_or_si256(_mm256_slli_epi64(v, 1), _mm256_slli_si256(_mm256_srli_epi64(v, 63), 8));
+}
+
+__attribute__((target("avx2"))) inline void cullFacesAVX2(const FaceCullInput& in, FaceCullOutput& out) {
+    const __m256i topBit = _mm256_set_epi64x(static_cast<long long>(std::uint64_t{1} << 63), 0, static_cast<long long>(std::uint64_t{1} << 63), 0);
+    const __m256i bottomBit = _mm256_set_epi64x(0, 1, 0, 1);
+
+    for (int x = 0; x < CULL_CHUNK_WIDTH; ++x) {
+        for (int z = 0; z < CULL_CHUNK_WIDTH; z += 2) {
+            const int p = FaceCullInput::paddedIndex(x + 1, z + 1);
+            const int c = x * CULL_CHUNK_WIDTH + z;
+            const __m256i solid = loadColumns(&in.solid[p]);
+
+            for (int face = 0; face < 4; ++face) {
+                const int n = p + CULL_NEIGHBOUR_OFFSETS[face];
+                __m256i hidden = _mm256_setzero_si256();
+                for (int k = 0; k < LIQUID_COUNT; ++k) {
+                    hidden = _mm256_or_si256(hidden, _mm256_and_si256(loadColumns(&in.liquid[k][p]), loadColumns(&in.liquid[k][n])));
+                }
+                const __m256i visible = _mm256_andnot_si256(hidden, _mm256_and_si256(solid, loadColumns(&in.transparent[n])));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.visible[face][c]), visible);
+            }
+
+            const __m256i t = loadColumns(&in.transparent[p]);
+            __m256i up = _mm256_or_si256(shiftColumnsUp(t), topBit);
+            __m256i down = _mm256_or_si256(shiftColumnsDown(t), bottomBit);
+            for (int k = 0; k < LIQUID_COUNT; ++k) {
+                const __m256i l = loadColumns(&in.liquid[k][p]);
+                up = _mm256_andnot_si256(_mm256_and_si256(l, shiftColumnsUp(l)), up);
+                down = _mm256_andnot_si256(_mm256_and_si256(l, shiftColumnsDown(l)), down);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.visible[4][c]), _mm256_and_si256(solid, up));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.visible[5][c]), _mm256_and_si256(solid, down));
+        }
+    }
+}
+#endif
+
+// Picks the AVX2 kernel when the CPU has it, the scalar one otherwise
+inline void cullFaces(const FaceCullInput& in, FaceCullOutput& out) {
+#ifdef FACE_CULLING_AVX2
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2) {
+        cullFacesAVX2(in, out);
+        return;
+    }
+#endif
+    cullFacesScalar(in, out);
+}
+
+#endif // FACE_CULLING_H
@@ -0,0 +1,105 @@
+#ifndef FACE_FORMAT_H
+#define FACE_FORMAT_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// One visible block face as uploaded to the GPU, decoded again in shaders/Gay.vert.
+//   position: x (4 bits) | y (7 bits) | z (4 bits) | face (3 bits) | flags (2 bits) | width - 1 (4 bits) | height - 1 (4 bits)
+//   texture:  atlas tile (8 bits) | overlay atlas tile (8 bits)
+// x, y, z are the chunk-local block the quad starts at. Greedy meshing stretches the quad over width x height blocks
+// along the face's local x and y axes, the texture repeats once per block.
+// The chunk's world offset is a per-draw uniform, so nothing here depends on where the chunk is.
+struct PackedFace {
+    std::uint32_t position;
+    std::uint32_t texture;
+};
+static_assert(sizeof(PackedFace) == 8, "PackedFace must stay 8 bytes per instance");
+
+// Face indices, same order as Block::textureOffsets
+enum FaceDirection : std::uint32_t {
+    FACE_NEG_Z = 0,
+    FACE_POS_Z = 1,
+    FACE_NEG_X = 2,
+    FACE_POS_X = 3,
+    FACE_POS_Y = 4,
+    FACE_NEG_Y = 5
+};
+
+enum FaceFlags : std::uint32_t {
+    FACE_CACTUS_INSET = 1,  // Side faces pulled 1/16 towards the block centre
+    FACE_LIQUID_LOWERED = 2 // Liquid surface 1/16 below the block top, sides shortened to match
+};
+
+constexpr int MAX_QUAD_SIZE = 16;
+
+constexpr PackedFace encodeFace(int x, int y, int z, std::uint32_t face, std::uint32_t flags, std::uint8_t tile, std::uint8_t overlayTile,
+                                int width = 1, int height = 1) {
+    return {
+        static_cast<std::uint32_t>(x) | static_cast<std::uint32_t>(y) << 4 | static_cast<std::uint32_t>(z) << 11 | face << 15 | flags << 18 |
+            static_cast<std::uint32_t>(width - 1) << 20 | static_cast<std::uint32_t>(height - 1) << 24,
+        static_cast<std::uint32_t>(tile) | static_cast<std::uint32_t>(overlayTile) << 8
+    };
+}
+
+struct DecodedFace {
+    int x, y, z;
+    std::uint32_t face;
+    std::uint32_t flags;
+    std::uint8_t tile;
+    std::uint8_t overlayTile;
+    int width, height;
+};
+
+constexpr DecodedFace decodeFace(PackedFace packed) {
+    return {
+        static_cast<int>(packed.position & 0xF),
+        static_cast<int>(packed.position >> 4 & 0x7F),
+        static_cast<int>(packed.position >> 11 & 0xF),
+        packed.position >> 15 & 0x7,
+        packed.position >> 18 & 0x3,
+        static_cast<std::uint8_t>(packed.texture & 0xFF),
+        static_cast<std::uint8_t>(packed.texture >> 8 & 0xFF),
+        static_cast<int>(packed.position >> 20 & 0xF) + 1,
+        static_cast<int>(packed.position >> 24 & 0xF) + 1
+    };
+}
+
+constexpr glm::vec3 FACE_NORMALS[6] = {
+    {0.0f, 0.0f, -1.0f},
+    {0.0f, 0.0f, 1.0f},
+    {-1.0f, 0.0f, 0.0f},
+    {1.0f, 0.0f, 0.0f},
+    {0.0f, 1.0f, 0.0f},
+    {0.0f, -1.0f, 0.0f}
+};
+
+// CPU copy of the vertex shader's position decoding, corner is a vertex of the unit quad at z = -0.5.
+// Keep this in sync with shaders/Gay.vert.
+inline glm::vec3 decodeFaceVertex(PackedFace packed, glm::vec2 chunkOffset, glm::vec3 corner) {
+    const DecodedFace f = decodeFace(packed);
+    corner.x = (corner.x + 0.5f) * f.width - 0.5f;
+    corner.y = (corner.y + 0.5f) * f.height - 0.5f;
+    glm::vec3 p;
+    switch (f.face) {
+        case FACE_NEG_Z: p = corner; break;
+        case FACE_POS_Z: p = glm::vec3(-corner.x, corner.y, -corner.z); break;
+        case FACE_NEG_X: p = glm::vec3(corner.z, corner.y, -corner.x); break;
+        case FACE_POS_X: p = glm::vec3(-corner.z, corner.y, corner.x); break;
+        case FACE_POS_Y: p = glm::vec3(corner.x, -corner.z, corner.y); break;
+        default: p = glm::vec3(corner.x, corner.z, -corner.y); break;
+    }
+    if (f.flags & FACE_LIQUID_LOWERED) {
+        if (f.face == FACE_POS_Y) {
+            p.y -= 1.0f / 16;
+        } else {
+            p.y = (p.y - 1.0f / 32) * (1.0f - 1.0f / 16);
+        }
+    }
+    if (f.flags & FACE_CACTUS_INSET) {
+        p -= FACE_NORMALS[f.face] * (1.0f / 16);
+    }
+    return glm::vec3(chunkOffset.x + f.x, f.y, chunkOffset.y + f.z) + p;
+}
+
+#endif // FACE_FORMAT_H
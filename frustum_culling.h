@@ -0,0 +1,155 @@
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FRUSTUM_CULLING_AVX 1
+#else
+#define FRUSTUM_CULLING_AVX 0
+#endif
+
+// The six planes of a view frustum, each as (normal, distance) with the normal pointing into the frustum, so a
+// point p is inside a plane when dot(normal, p) + distance >= 0
+struct Frustum {
+    glm::vec4 planes[6]; // Left, right, bottom, top, near, far
+
+    // Gribb-Hartmann extraction from projection * view, which gives the planes in world space
+    static Frustum fromMatrix(const glm::mat4& viewProjection) {
+        // glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        Frustum frustum{{row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2}};
+        for (glm::vec4& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    // A box is outside when its corner furthest along a plane's normal is behind that plane. Boxes that straddle the
+    // frustum's corners can pass without being visible, never the other way round.
+    bool intersects(glm::vec3 min, glm::vec3 max) const {
+        for (const glm::vec4& plane : planes) {
+            const float x = plane.x >= 0.0f ? max.x : min.x;
+            const float y = plane.y >= 0.0f ? max.y : min.y;
+            const float z = plane.z >= 0.0f ? max.z : min.z;
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// What culling left to draw in the last frame, for the debug window
+struct CullingStats {
+    std::size_t chunks = 0;
+    std::size_t visibleChunks = 0;
+    std::size_t sections = 0;        // Sections with faces, of all chunks
+    std::size_t visibleSections = 0;
+    std::size_t occludedSections = 0; // In the frustum but not reachable from the camera through open blocks
+    std::size_t draws = 0;
+};
+
+// Axis aligned boxes in structure of arrays form, so the culling kernel loads eight boxes per coordinate at once.
+// The arrays are padded to a multiple of eight with empty boxes that are never reported as visible.
+class AabbBatch {
+public:
+    static constexpr std::size_t LANES = 8;
+
+    void clear() {
+        count = 0;
+        for (std::vector<float>* coordinate : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+            coordinate->clear();
+        }
+    }
+
+    // Returns the box's index, which is what cullAabbs() reports
+    std::uint32_t add(glm::vec3 min, glm::vec3 max) {
+        if (count % LANES == 0) {
+            // Start a new block of lanes, filled with boxes that fail every plane test
+            for (std::vector<float>* coordinate : {&minX, &minY, &minZ}) coordinate->resize(count + LANES, INFINITY);
+            for (std::vector<float>* coordinate : {&maxX, &maxY, &maxZ}) coordinate->resize(count + LANES, -INFINITY);
+        }
+        minX[count] = min.x;
+        minY[count] = min.y;
+        minZ[count] = min.z;
+        maxX[count] = max.x;
+        maxY[count] = max.y;
+        maxZ[count] = max.z;
+        return static_cast<std::uint32_t>(count++);
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ; // Padded to a multiple of LANES
+
+private:
+    std::size_t count = 0;
+};
+
+// Scalar version, one box at a time with Frustum::intersects()
+inline void cullAabbsScalar(const Frustum& frustum, const AabbBatch& boxes, std::vector<std::uint32_t>& visible) {
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        if (frustum.intersects(glm::vec3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), glm::vec3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]))) {
+            visible.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+#if FRUSTUM_CULLING_AVX
+// Same test on eight boxes at a time. The sign of a plane's normal is the same for all boxes, so which of min or
+// max is the furthest corner is decided once per plane and the kernel only loads from the chosen arrays.
+__attribute__((target("avx")))
+inline void cullAabbsAVX(const Frustum& frustum, const AabbBatch& boxes, std::vector<std::uint32_t>& visible) {
+    const float* cornerX[6];
+    const float* cornerY[6];
+    const float* cornerZ[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        cornerX[p] = plane.x >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+        cornerY[p] = plane.y >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+        cornerZ[p] = plane.z >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+    }
+
+    for (std::size_t base = 0; base < boxes.size(); base += AabbBatch::LANES) {
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const glm::vec4& plane = frustum.planes[p];
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(cornerX[p] + base)),
+                                            _mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(cornerY[p] + base)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(cornerZ[p] + base)));
+            distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        // Padding boxes are infinitely far behind some plane, so they never set a bit
+        for (unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+            visible.push_back(static_cast<std::uint32_t>(base + __builtin_ctz(mask)));
+        }
+    }
+}
+#endif
+
+// Appends the indices of the boxes that are at least partly inside the frustum to visible, in ascending order
+inline void cullAabbs(const Frustum& frustum, const AabbBatch& boxes, std::vector<std::uint32_t>& visible) {
+#if FRUSTUM_CULLING_AVX
+    static const bool hasAVX = __builtin_cpu_supports("avx");
+    if (hasAVX) {
+        cullAabbsAVX(frustum, boxes, visible);
+        return;
+    }
+#endif
+    cullAabbsScalar(frustum, boxes, visible);
+}
+
+#endif // FRUSTUM_CULLING_H
@@ -0,0 +1,67 @@
+#ifndef GL_RENDER_STATE_BACKEND_H
+#define GL_RENDER_STATE_BACKEND_H
+
+#include <glad/glad.h>
+#include "render_state.h"
+
+// RenderState forwarding to the OpenGL context that is current
+class GLRenderStateBackend : public RenderStateBackend {
+public:
+    void useProgram(std::uint32_t program) override {
+        glUseProgram(program);
+    }
+
+    void bindVertexArray(std::uint32_t vertexArray) override {
+        glBindVertexArray(vertexArray);
+    }
+
+    void bindBuffer(std::uint32_t target, std::uint32_t buffer) override {
+        glBindBuffer(target, buffer);
+    }
+
+    void activeTexture(std::uint32_t unit) override {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    void bindTexture(std::uint32_t target, std::uint32_t texture) override {
+        glBindTexture(target, texture);
+    }
+
+    void bindSampler(std::uint32_t unit, std::uint32_t sampler) override {
+        glBindSampler(unit, sampler);
+    }
+
+    void setCapability(std::uint32_t capability, bool enabled) override {
+        if (enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+    }
+
+    void blendFunc(std::uint32_t source, std::uint32_t destination) override {
+        glBlendFunc(source, destination);
+    }
+
+    std::uint32_t createSampler(const SamplerState& state) override {
+        GLuint sampler;
+        glGenSamplers(1, &sampler);
+        glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(state.minFilter));
+        glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(state.magFilter));
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, static_cast<GLint>(state.wrapS));
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, static_cast<GLint>(state.wrapT));
+        return sampler;
+    }
+};
+
+// Nearest filtering and clamped edges, how the block and HUD atlases are sampled
+constexpr SamplerState ATLAS_SAMPLER = {GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE};
+
+// The one tracker all rendering goes through, for the GL context of the window
+inline RenderState& renderState() {
+    static GLRenderStateBackend backend;
+    static RenderState state(backend);
+    return state;
+}
+
+#endif // GL_RENDER_STATE_BACKEND_H
@@ -0,0 +1,57 @@
+#ifndef GL_UNIFORM_BACKEND_H
+#define GL_UNIFORM_BACKEND_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "uniform_table.h"
+
+// UniformTable backed by the OpenGL context that is current
+class GLUniformBackend : public UniformBackend {
+public:
+    std::vector<std::pair<std::string, int>> activeUniforms(std::uint32_t program) override {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<std::pair<std::string, int>> uniforms;
+        std::vector<GLchar> name(static_cast<std::size_t>(std::max(maxLength, 1)));
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+            std::string uniform(name.data(), static_cast<std::size_t>(length));
+            if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0) {
+                uniform.resize(uniform.size() - 3);
+            }
+            // Uniforms in blocks have no location and come back as -1
+            const GLint location = glGetUniformLocation(program, uniform.c_str());
+            uniforms.emplace_back(std::move(uniform), location);
+        }
+        return uniforms;
+    }
+
+    void upload(int location, UniformKind kind, const void* value) override {
+        const auto* floats = static_cast<const GLfloat*>(value);
+        switch (kind) {
+            case UniformKind::Int: glUniform1i(location, *static_cast<const GLint*>(value)); break;
+            case UniformKind::Float: glUniform1f(location, *floats); break;
+            case UniformKind::Vec2: glUniform2fv(location, 1, floats); break;
+            case UniformKind::Vec3: glUniform3fv(location, 1, floats); break;
+            case UniformKind::Vec4: glUniform4fv(location, 1, floats); break;
+            case UniformKind::Mat2: glUniformMatrix2fv(location, 1, GL_FALSE, floats); break;
+            case UniformKind::Mat3: glUniformMatrix3fv(location, 1, GL_FALSE, floats); break;
+            case UniformKind::Mat4: glUniformMatrix4fv(location, 1, GL_FALSE, floats); break;
+        }
+    }
+};
+
+// Shared by every Shader, it holds no state of its own
+inline GLUniformBackend& glUniformBackend() {
+    static GLUniformBackend backend;
+    return backend;
+}
+
+#endif // GL_UNIFORM_BACKEND_H
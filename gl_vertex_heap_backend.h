@@ -0,0 +1,40 @@
+#ifndef GL_VERTEX_HEAP_BACKEND_H
+#define GL_VERTEX_HEAP_BACKEND_H
+
+#include <glad/glad.h>
+#include "vertex_heap.h"
+
+// VertexHeap storage as OpenGL buffer objects. Copies go through GL_COPY_READ/WRITE_BUFFER so the
+// GL_ARRAY_BUFFER binding of whoever is drawing is left alone.
+class GLVertexHeapBackend : public VertexHeapBackend {
+public:
+    std::uint32_t createBuffer(std::size_t bytes) override {
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+
+    void destroyBuffer(std::uint32_t buffer) override {
+        const GLuint id = buffer;
+        glDeleteBuffers(1, &id);
+    }
+
+    void upload(std::uint32_t buffer, std::size_t offset, const void* data, std::size_t bytes) override {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void copy(std::uint32_t source, std::uint32_t destination, std::size_t bytes) override {
+        glBindBuffer(GL_COPY_READ_BUFFER, source);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(bytes));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+};
+
+#endif // GL_VERTEX_HEAP_BACKEND_H
@@ -0,0 +1,180 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Higher priorities always run first, on every worker
+enum class JobPriority {
+    High,
+    Normal,
+    Low
+};
+constexpr int JOB_PRIORITY_COUNT = 3;
+
+struct JobSystemStats {
+    std::size_t workers = 0;
+    std::size_t queued[JOB_PRIORITY_COUNT] = {}; // Waiting jobs per priority, summed over all workers
+    std::uint64_t executed = 0;
+    std::uint64_t steals = 0;                    // Jobs a worker took from another worker's deque
+};
+
+// Fixed pool of worker threads. Every worker owns one deque per priority: it pushes and pops its own jobs at the
+// back, idle workers steal from the front of the others. Jobs submitted from outside the pool are spread round
+// robin, jobs submitted by a running job stay on that worker until someone steals them.
+class JobSystem {
+public:
+    explicit JobSystem(std::size_t workerCount = defaultWorkerCount()) : workers(std::max<std::size_t>(workerCount, 1)) {
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            workers[i].thread = std::thread([this, i] { run(i); });
+        }
+    }
+
+    ~JobSystem() {
+        shutdown();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // One worker per core, minus the main thread
+    static std::size_t defaultWorkerCount() {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+    // Runs fn on a worker, the future gets its result or exception
+    template <typename Fn>
+    auto submit(Fn fn, JobPriority priority = JobPriority::Normal) -> std::future<std::invoke_result_t<Fn&>> {
+        using Result = std::invoke_result_t<Fn&>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+        std::future<Result> future = task->get_future();
+        push([task] { (*task)(); }, priority);
+        return future;
+    }
+
+    // Same as submit() when nobody waits for the result
+    template <typename Fn>
+    void dispatch(Fn fn, JobPriority priority = JobPriority::Normal) {
+        push(std::function<void()>(std::move(fn)), priority);
+    }
+
+    // Lets the running jobs finish and stops the workers, jobs still queued are dropped
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            if (stopping) return;
+            stopping = true;
+        }
+        wake.notify_all();
+        for (Worker& worker : workers) {
+            if (worker.thread.joinable()) worker.thread.join();
+        }
+    }
+
+    JobSystemStats stats() {
+        JobSystemStats result;
+        result.workers = workers.size();
+        for (Worker& worker : workers) {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            for (int p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+                result.queued[p] += worker.queues[p].size();
+            }
+        }
+        result.executed = executed.load(std::memory_order_relaxed);
+        result.steals = steals.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<std::function<void()>> queues[JOB_PRIORITY_COUNT];
+    };
+
+    std::vector<Worker> workers;
+    std::atomic<std::size_t> pending{0};      // Jobs queued anywhere, what sleeping workers wait on
+    std::atomic<std::size_t> nextWorker{0};   // Round robin target for jobs from outside the pool
+    std::atomic<std::uint64_t> executed{0};
+    std::atomic<std::uint64_t> steals{0};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // The pool and worker index of the calling thread, if it is a worker at all
+    static inline thread_local const JobSystem* currentPool = nullptr;
+    static inline thread_local std::size_t currentWorker = 0;
+
+    void push(std::function<void()> job, JobPriority priority) {
+        const std::size_t target = currentPool == this ? currentWorker : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        {
+            // Counted before it is queued, so pending never drops below the number of queued jobs
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(workers[target].mutex);
+            workers[target].queues[static_cast<int>(priority)].push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    // Highest priority first; within a priority the own deque (newest job) before stealing (oldest job)
+    bool take(std::size_t self, std::function<void()>& job) {
+        for (int p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+            {
+                Worker& own = workers[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.queues[p].empty()) {
+                    job = std::move(own.queues[p].back());
+                    own.queues[p].pop_back();
+                    return true;
+                }
+            }
+            for (std::size_t offset = 1; offset < workers.size(); ++offset) {
+                Worker& victim = workers[(self + offset) % workers.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.queues[p].empty()) {
+                    job = std::move(victim.queues[p].front());
+                    victim.queues[p].pop_front();
+                    steals.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void run(std::size_t self) {
+        currentPool = this;
+        currentWorker = self;
+        std::function<void()> job;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait(lock, [this] { return stopping || pending.load(std::memory_order_relaxed) > 0; });
+                if (stopping) return;
+            }
+            if (take(self, job)) {
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                job();
+                job = nullptr;
+                executed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+#endif // JOB_SYSTEM_H
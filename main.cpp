@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <iomanip>
 #include "shader.h"
@@ -8,10 +12,19 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <random>
 #include <thread>
 #include "stb_image.h"
 #include <unordered_map>
 #include "chunk.cpp"
+#include "gl_vertex_heap_backend.h"
+#include "job_system.h"
+#include "camera_path.h"
+#include "chunk_pipeline.h"
+#include "chunk_prefetch.h"
+#include "chunk_window.h"
+#include "world_store.h"
+#include "frustum_culling.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
@@ -31,10 +44,11 @@ constexpr int BLOCKS_PER_CHUNK = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
 
 //std::vector chunks(chunkSizeX, std::vector(chunkSizeZ, Chunk(0, 0)));
 
-std::map<std::pair<int, int>, Chunk> chunkMap;
+ChunkMap chunkMap;
 
-std::vector<std::thread> threads;
-std::vector<Chunk*> renderedChunks;
+JobSystem jobSystem; // Runs every background task: chunk generation, meshing and cleanup
+WorldStore worldStore(std::filesystem::path(worldDirectory) / std::to_string(seed));
+std::atomic<MeshingMode> meshingMode(MeshingMode::Greedy); // Used for every chunk meshed from now on
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
@@ -128,126 +142,635 @@ glm::vec4 getPixelColor(const std::string& filePath, int x, int y) {
 
 std::mutex chunkMutex;  // To protect shared resources
 std::atomic<bool> cleanupInProgress(false);  // To prevent overlapping cleanups
-GLuint instanceVBOla;
+ChunkPipeline chunkPipeline(chunkMap, chunkMutex, jobSystem, cleanupRadius, &worldStore);
+ChunkPrefetch chunkPrefetch(prefetchDistance, unloadSlack, prefetchSeconds);
+
+std::mutex unloadedMutex;
+std::vector<std::pair<int, int>> unloadedChunks; // Chunks whose slices can be freed, drained by the main thread
+
+std::vector<ChunkPosition> chunksLeftWindow; // Scrolled out of the chunk window, only touched by the main thread
+// Positions to unload, owned by the cleanup job while cleanupInProgress is set and by the main thread otherwise
+std::vector<ChunkPosition> pendingUnloads;
+
+// Takes a chunk out of the chunk map, called from inside an update with the map's mutex held. Unsaved changes are
+// queued with the world store before the chunk goes, so a Terrain stage that allocates it again as soon as the mutex
+// is released finds them instead of generating the chunk from scratch.
+void unloadChunk(ChunkMap::Writer& writer, const ChunkPosition& position, Chunk& chunk) {
+    if (chunk.dirty && chunk.stage >= ChunkStage::Decorated) {
+        std::vector<std::uint8_t> data;
+        chunk.serialize(data);
+        worldStore.save(position.first, position.second, std::move(data));
+        chunk.dirty = false;
+    }
+    writer.erase(position);
+}
 
-void cleanupChunksAsync(const glm::vec2& chunkPosition,
-                        std::map<std::pair<int, int>, Chunk>& chunkMap,
-                        std::vector<Chunk*>& renderedChunks,
+// Unloads the chunks that scrolled out of the chunk window since the last cleanup, instead of going over every
+// loaded chunk to find them. anchor is the window's centre, see ChunkFocus.
+void cleanupChunksAsync(ChunkPosition anchor,
+                        ChunkMap& chunkMap,
                         int cleanupRadius) {
     if (cleanupInProgress) return; // Skip if a cleanup is already in progress
+    pendingUnloads.insert(pendingUnloads.end(), chunksLeftWindow.begin(), chunksLeftWindow.end());
+    chunksLeftWindow.clear();
+    if (pendingUnloads.empty()) return;
     cleanupInProgress = true;
 
-    std::thread([chunkPosition, &chunkMap, &renderedChunks, cleanupRadius]() {
-        std::vector<std::pair<int, int>> chunksToRemove;
-
-        // Identify chunks to be removed
+    jobSystem.dispatch([anchor, &chunkMap, cleanupRadius]() {
+        // Remove chunks from chunkMap. Readers that still hold one of them keep it alive, it is freed once the last
+        // of them lets go.
+        std::vector<ChunkPosition> retry;
         {
             std::lock_guard<std::mutex> lock(chunkMutex);
-            for (const auto& [position, chunk] : chunkMap) {
-                int dx = position.first - static_cast<int>(chunkPosition.x);
-                int dz = position.second - static_cast<int>(chunkPosition.y);
-
-                if (std::abs(dx) > cleanupRadius || std::abs(dz) > cleanupRadius) {
-                    chunksToRemove.push_back(position);
+            chunkMap.update([&](ChunkMap::Writer& writer) {
+                for (const auto& position : pendingUnloads) {
+                    auto it = writer.view().find(position);
+                    if (it == writer.view().end()) {
+                        continue;
+                    }
+                    int dx = position.first - anchor.first;
+                    int dz = position.second - anchor.second;
+                    if (std::abs(dx) <= cleanupRadius && std::abs(dz) <= cleanupRadius) {
+                        // Back in the window before it was unloaded, its slice went when it left
+                        if (it->second->stage == ChunkStage::Uploaded) {
+                            chunkPipeline.markUnmeshed(*it->second);
+                        }
+                        continue;
+                    }
+                    // Chunks a pipeline job still works on or reads are left for a later cleanup
+                    if (it->second->jobRefs > 0) {
+                        retry.push_back(position);
+                        continue;
+                    }
+                    unloadChunk(writer, position, *it->second);
+                    std::lock_guard<std::mutex> queueLock(unloadedMutex);
+                    unloadedChunks.push_back(position);
                 }
+            });
+        }
+        pendingUnloads.swap(retry);
+        cleanupInProgress = false;
+    }, JobPriority::Low);
+}
+
+// Where each chunk's faces are in the vertex heap, only touched by the main thread
+struct ChunkSlice {
+    VertexHeapAllocation allocation;
+    std::array<std::uint32_t, SECTIONS_PER_CHUNK + 1> sectionStarts; // Face ranges per section, see ChunkMesh
+    std::array<SectionConnectivity, SECTIONS_PER_CHUNK> connectivity;
+};
+// Slices of the chunks within cleanupRadius of the focus anchor, the same square cleanup keeps loaded. Moved along
+// with the anchor by flushChunkUploads(), which frees the slices that scroll out and hands their positions to cleanup.
+ChunkWindow<ChunkSlice> chunkSlices(cleanupRadius);
+
+// A run of faces from one chunk's slice that passed frustum culling, drawn with one instanced draw
+struct ChunkDraw {
+    std::pair<int, int> position;
+    std::uint32_t firstFace;
+    std::uint32_t faceCount;
+};
+
+AabbBatch chunkBoxes, sectionBoxes; // Reused every frame, like the index lists below
+std::vector<std::uint32_t> visibleChunks, visibleSections;
+std::vector<std::pair<ChunkPosition, const ChunkSlice*>> boxedChunks;
+std::vector<std::pair<std::uint32_t, int>> boxedSections; // Chunk index in boxedChunks and section
+VisibleSections reachableSections;
+
+// Culls whole chunks first and then the sections of the chunks that are left, drops the sections the camera can't
+// see through open blocks, and turns the rest into draws, merging neighbouring sections of a chunk into one draw.
+// Draws come out nearest chunk first, so near geometry fills the depth buffer before what it hides is shaded.
+// Blocks are centred on integer coordinates, and a greedy quad can reach up to MAX_QUAD_SIZE - 1 blocks above the
+// section it starts in, which the boxes include, so a section is also drawn when only the one above it is reachable.
+std::vector<ChunkDraw> cullChunkSlices(const Frustum& frustum, glm::vec3 cameraPosition, CullingStats& stats) {
+    static_assert(MAX_QUAD_SIZE <= SECTION_SIZE + 1, "Quads may reach more than one section up");
+    // The walk only enters sections inside the frustum, a line of sight never leaves it
+    const bool occlusion = caveCulling && findVisibleSections(cameraPosition, SECTIONS_PER_CHUNK, renderDistance + 1,
+        [&frustum](int chunkX, int sectionY, int chunkZ) -> const SectionConnectivity* {
+            const ChunkSlice* slice = chunkSlices.find(chunkX, chunkZ);
+            if (slice == nullptr) {
+                return nullptr;
+            }
+            const glm::vec3 origin(chunkX * CHUNK_SIZE_X - 0.5f, sectionY * SECTION_SIZE - 0.5f, chunkZ * CHUNK_SIZE_Z - 0.5f);
+            return frustum.intersects(origin, origin + glm::vec3(CHUNK_SIZE_X, SECTION_SIZE, CHUNK_SIZE_Z)) ? &slice->connectivity[sectionY] : nullptr;
+        }, reachableSections);
+
+    chunkBoxes.clear();
+    boxedChunks.clear();
+    chunkSlices.forEachNearestFirst([](ChunkPosition position, const ChunkSlice& slice) {
+        if (slice.allocation.size == 0) {
+            return;
+        }
+        const glm::vec3 origin(position.first * CHUNK_SIZE_X - 0.5f, -0.5f, position.second * CHUNK_SIZE_Z - 0.5f);
+        chunkBoxes.add(origin, origin + glm::vec3(CHUNK_SIZE_X, CHUNK_SIZE_Y, CHUNK_SIZE_Z));
+        boxedChunks.emplace_back(position, &slice);
+    });
+    visibleChunks.clear();
+    cullAabbs(frustum, chunkBoxes, visibleChunks);
+
+    sectionBoxes.clear();
+    boxedSections.clear();
+    for (std::uint32_t chunk : visibleChunks) {
+        const auto& [position, slice] = boxedChunks[chunk];
+        for (int section = 0; section < SECTIONS_PER_CHUNK; ++section) {
+            if (slice->sectionStarts[section] == slice->sectionStarts[section + 1]) {
+                continue;
             }
+            const glm::vec3 origin(position.first * CHUNK_SIZE_X - 0.5f, section * SECTION_SIZE - 0.5f, position.second * CHUNK_SIZE_Z - 0.5f);
+            sectionBoxes.add(origin, origin + glm::vec3(CHUNK_SIZE_X, SECTION_SIZE + MAX_QUAD_SIZE - 1, CHUNK_SIZE_Z));
+            boxedSections.emplace_back(chunk, section);
+        }
+    }
+    visibleSections.clear();
+    cullAabbs(frustum, sectionBoxes, visibleSections);
+
+    std::size_t drawnSections = 0;
+    std::vector<ChunkDraw> draws;
+    for (std::uint32_t index : visibleSections) {
+        const auto [chunk, section] = boxedSections[index];
+        const auto& [position, slice] = boxedChunks[chunk];
+        if (occlusion) {
+            auto reachable = reachableSections.find(position);
+            if (reachable == reachableSections.end() || ((reachable->second | reachable->second >> 1) >> section & 1) == 0) {
+                continue;
+            }
+        }
+        drawnSections++;
+        const std::uint32_t first = slice->sectionStarts[section];
+        const std::uint32_t count = slice->sectionStarts[section + 1] - first;
+        if (!draws.empty() && draws.back().position == position && draws.back().firstFace + draws.back().faceCount == first) {
+            draws.back().faceCount += count;
+        } else {
+            draws.push_back({position, first, count});
         }
+    }
 
-        // Remove chunks from chunkMap and renderedChunks
-        {
+    stats.chunks = chunkBoxes.size();
+    stats.visibleChunks = visibleChunks.size();
+    stats.sections = 0;
+    for (const auto& [position, slice] : boxedChunks) {
+        for (int section = 0; section < SECTIONS_PER_CHUNK; ++section) {
+            stats.sections += slice->sectionStarts[section] != slice->sectionStarts[section + 1];
+        }
+    }
+    stats.visibleSections = drawnSections;
+    stats.occludedSections = visibleSections.size() - drawnSections;
+    stats.draws = draws.size();
+    return draws;
+}
+
+// Moves the chunk window to the focus anchor, frees the slices of unloaded chunks and of chunks that scrolled out,
+// and uploads newly meshed ones, replacing the slice of a chunk that was meshed before. The frustum only decides
+// which uploads count as geometry the player was waiting for.
+void flushChunkUploads(VertexHeap& heap, int centerX, int centerZ, const Frustum& frustum) {
+    chunkSlices.recenter(centerX, centerZ, [&heap](ChunkPosition position, ChunkSlice* slice) {
+        if (slice != nullptr) {
+            heap.free(slice->allocation);
+        }
+        chunksLeftWindow.push_back(position);
+    });
+
+    std::vector<ChunkMesh> meshes = chunkPipeline.takeMeshes();
+    std::vector<std::pair<int, int>> unloaded;
+    {
+        std::lock_guard<std::mutex> lock(unloadedMutex);
+        unloaded.swap(unloadedChunks);
+    }
+
+    for (const auto& [x, z] : unloaded) {
+        if (ChunkSlice* slice = chunkSlices.find(x, z)) {
+            heap.free(slice->allocation);
+            chunkSlices.erase(x, z);
+        }
+    }
+
+    // No lock, the snapshot says which chunks are loaded right now
+    const std::shared_ptr<const ChunkMap::Entries> loaded = chunkMap.snapshot();
+    for (const ChunkMesh& mesh : meshes) {
+        const std::pair<int, int> position(mesh.chunkX, mesh.chunkZ);
+        auto chunk = loaded->find(position);
+        if (chunk == loaded->end() || ChunkMap::handle(*chunk->second) != mesh.chunk) {
+            continue; // Unloaded since, possibly already allocated again
+        }
+        if (!chunkSlices.contains(mesh.chunkX, mesh.chunkZ)) {
+            // Left the window while it was meshed and is about to be unloaded. Should it come back first, it has
+            // to be meshed again.
             std::lock_guard<std::mutex> lock(chunkMutex);
-            for (const auto& position : chunksToRemove) {
-                auto it = chunkMap.find(position);
-                if (it != chunkMap.end()) {
-                    // Remove from chunkMap
-                    Chunk* chunkPtr = &it->second;
-                    chunkMap.erase(it);
-
-                    // Remove from renderedChunks
-                    auto renderedIt = std::ranges::find(renderedChunks, chunkPtr);
-                    if (renderedIt != renderedChunks.end()) {
-                        renderedChunks.erase(renderedIt);
-                    }
+            chunkPipeline.markUnmeshed(*chunk->second);
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        ChunkSlice& slice = chunkSlices.emplace(mesh.chunkX, mesh.chunkZ);
+        heap.free(slice.allocation); // The chunk's previous slice, if it was meshed before
+        slice = {heap.allocate(mesh.faces.size() * sizeof(PackedFace), mesh.faces.data()), mesh.sectionStarts, mesh.connectivity};
+        const double uploadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const glm::vec3 origin(mesh.chunkX * CHUNK_SIZE_X - 0.5f, -0.5f, mesh.chunkZ * CHUNK_SIZE_Z - 0.5f);
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        chunkPipeline.markUploaded(*chunk->second, mesh, uploadMilliseconds,
+                                   frustum.intersects(origin, origin + glm::vec3(CHUNK_SIZE_X, CHUNK_SIZE_Y, CHUNK_SIZE_Z)));
+    }
+}
+
+// Meshes every loaded chunk once per meshing mode on the calling thread, so both modes see the same chunks and seed
+std::vector<MeshBenchmarkResult> benchmarkMeshing() {
+    // Blocks of decorated chunks are final, so they are read straight from a snapshot without locking the map.
+    // Chunks still being generated are skipped, both as chunks and as neighbours.
+    const std::shared_ptr<const ChunkMap::Entries> loaded = chunkMap.snapshot();
+    auto find = [&loaded](int x, int z) -> const Chunk* {
+        auto it = loaded->find({x, z});
+        return it != loaded->end() && it->second->stage >= ChunkStage::Decorated ? it->second.get() : nullptr;
+    };
+
+    std::vector<MeshBenchmarkResult> results;
+    std::vector<PackedFace> faces;
+    for (MeshingMode mode : {MeshingMode::PerFace, MeshingMode::Greedy}) {
+        MeshBenchmarkResult result;
+        result.mode = mode == MeshingMode::Greedy ? "Greedy" : "Per face";
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& [position, chunk] : *loaded) {
+            const auto [x, z] = position;
+            if (chunk->stage < ChunkStage::Decorated) {
+                continue;
+            }
+            chunk->buildMesh(mode, find(x + 1, z), find(x - 1, z), find(x, z + 1), find(x, z - 1), faces);
+            result.faces += faces.size();
+        }
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.bytes = result.faces * sizeof(PackedFace);
+        results.push_back(result);
+    }
+    return results;
+}
+
+// Generates the terrain of every loaded chunk twice on the calling thread, once on caveLatticeStep and once sampling
+// every block, into scratch chunks so the loaded ones stay untouched
+CaveSamplingComparison compareCaveSampling() {
+    std::vector<std::pair<int, int>> positions;
+    for (const auto& [position, chunk] : *chunkMap.snapshot()) {
+        positions.push_back(position);
+    }
+
+    CaveSamplingComparison result;
+    for (const auto& [x, z] : positions) {
+        Chunk coarse(x, z);
+        Chunk full(x, z);
+        const auto start = std::chrono::steady_clock::now();
+        result.coarseSamples += coarse.generateTerrain(x, z, caveLatticeStep);
+        const auto middle = std::chrono::steady_clock::now();
+        result.fullSamples += full.generateTerrain(x, z, {1, 1, 1});
+        const auto end = std::chrono::steady_clock::now();
+        result.coarseMilliseconds += std::chrono::duration<double, std::milli>(middle - start).count();
+        result.fullMilliseconds += std::chrono::duration<double, std::milli>(end - middle).count();
+
+        for (int bx = 0; bx < CHUNK_SIZE_X; ++bx) {
+            for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+                for (int bz = 0; bz < CHUNK_SIZE_Z; ++bz) {
+                    result.differingBlocks += coarse.getBlockId(bx, y, bz) != full.getBlockId(bx, y, bz);
                 }
             }
         }
+        result.chunks++;
+    }
+    result.blocks = result.chunks * CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
+    return result;
+}
 
-        //std::cout << "Async cleanup complete. Removed " << chunksToRemove.size() << " chunks.\n";
-        cleanupInProgress = false;
-    }).detach(); // Detach the thread to allow it to run independently
+// Saves every decorated chunk and waits until it is on disk, then reads them all back and generates them all again
+// into scratch chunks on the calling thread, so loading and generating are timed on the same chunks
+StorageBenchmarkResult benchmarkStorage() {
+    std::vector<std::pair<int, int>> positions;
+    {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        for (const auto& [position, chunk] : *chunkMap.snapshot()) {
+            if (chunk->stage < ChunkStage::Decorated || chunk->jobRefs > 0) {
+                continue;
+            }
+            std::vector<std::uint8_t> data;
+            chunk->serialize(data);
+            worldStore.save(position.first, position.second, std::move(data));
+            chunk->dirty = false;
+            positions.push_back(position);
+        }
+    }
+    worldStore.flush();
+
+    StorageBenchmarkResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& [x, z] : positions) {
+        Chunk chunk(x, z);
+        worldStore.load(x, z, [&](const std::uint8_t* data, std::size_t size) {
+            result.bytes += size;
+            return chunk.deserialize(data, size);
+        });
+    }
+    result.loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (const auto& [x, z] : positions) {
+        Chunk chunk(x, z);
+        chunk.generateChunk(x, z);
+    }
+    result.generateMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.chunks = positions.size();
+    return result;
 }
-std::atomic<bool> chunkLoadingInProgress(false);
 
+// Copies the non-uniform sections of every decorated chunk, then builds each of them in the flat and in the palette
+// layout on the calling thread and reads them back block by block and whole. Uniform sections hold no voxel array in
+// either layout and are left out.
+SectionStorageBenchmarkResult benchmarkSectionStorage() {
+    using Flat = ChunkStorage<SECTION_SIZE, SECTION_SIZE, SECTION_SIZE, ChunkSection::Storage::LAYOUT>;
+    using Palette = PaletteStorage<SECTION_SIZE, SECTION_SIZE, SECTION_SIZE, ChunkSection::Storage::LAYOUT>;
+    using Clock = std::chrono::steady_clock;
 
-std::vector<float> combinedData;
+    std::vector<std::vector<BlockID>> sections; // In Flat::index order
+    {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        for (const auto& [position, chunk] : *chunkMap.snapshot()) {
+            if (chunk->stage < ChunkStage::Decorated || chunk->jobRefs > 0) {
+                continue;
+            }
+            for (int sectionY = 0; sectionY < SECTIONS_PER_CHUNK; ++sectionY) {
+                const ChunkSection& section = chunk->getSection(sectionY);
+                if (section.isUniform()) continue;
+                sections.emplace_back(Flat::VOLUME);
+                section.unpack(sections.back().data());
+            }
+        }
+    }
 
-void loadChunksAsync(const glm::vec2& chunkPosition,
-                     std::map<std::pair<int, int>, Chunk>& chunkMap,
-                     std::vector<Chunk*>& renderedChunks,
-                     int renderDistance)
-{
-    if (chunkLoadingInProgress) {
-        return;
-    } // Avoid multiple threads running at once
-    chunkLoadingInProgress = true;
-
-    std::thread([chunkPosition, &chunkMap, &renderedChunks, renderDistance]() {
-        std::vector<float> combinedDeta;
-        int chunkRendered = 0, chunkLooped = 0;
-        for (int x = chunkPosition.x - renderDistance; x <= chunkPosition.x + renderDistance; x++) {
-            for (int z = chunkPosition.y - renderDistance; z <= chunkPosition.y + renderDistance; z++) {
-                chunkLooped++;
-                if (!chunkMap.contains({x, z})) {
-                    chunkMap.emplace(std::make_pair(x, z), Chunk(x, z));
-                    continue;
-                }
-                Chunk* chunka;
-                {
-                    std::lock_guard<std::mutex> lock(chunkMutex);
-                    if (!chunkMap.contains({x, z})) {
-                        chunkMap.emplace(std::make_pair(x, z), Chunk(x, z));
+    SectionStorageBenchmarkResult result;
+    result.sections = sections.size();
+    if (sections.empty()) return result;
+    const double blocks = static_cast<double>(sections.size()) * Flat::VOLUME;
+    auto nanoseconds = [blocks](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / blocks;
+    };
+
+    std::vector<BlockID> unpacked(Flat::VOLUME);
+    std::uint64_t checksum[2] = {}; // Used, so the reads aren't optimised away
+    auto run = [&](auto& storages, double& setNanoseconds, double& getNanoseconds, double& unpackNanoseconds,
+                   std::size_t& bytes, std::uint64_t& sum) {
+        auto start = Clock::now();
+        for (std::size_t s = 0; s < sections.size(); ++s) {
+            const BlockID* ids = sections[s].data();
+            for (int x = 0; x < SECTION_SIZE; ++x) {
+                for (int z = 0; z < SECTION_SIZE; ++z) {
+                    for (int y = 0; y < SECTION_SIZE; ++y) {
+                        storages[s].set(x, y, z, ids[Flat::index(x, y, z)]);
                     }
-                    chunka = &chunkMap.at({x, z});
                 }
-                if (std::ranges::find(renderedChunks, chunka) == renderedChunks.end()) {
-                    renderedChunks.push_back(chunka);
-                    Chunk* nX = nullptr;
-                    if (!chunkMap.contains({x - 1, z})) {
-                        chunkMap.emplace(std::make_pair(x - 1, z), Chunk(x - 1, z));
-                    }
-                    nX = &chunkMap.at({x - 1, z});
-                    Chunk* pX = nullptr;
-                    if (!chunkMap.contains({x + 1, z})) {
-                        chunkMap.emplace(std::make_pair(x + 1, z), Chunk(x + 1, z));
-                    }
-                    pX = &chunkMap.at({x + 1, z});
-                    Chunk* nZ = nullptr;
-                    if (!chunkMap.contains({x, z - 1})) {
-                        chunkMap.emplace(std::make_pair(x, z - 1), Chunk(x, z - 1));
-                    }
-                    nZ = &chunkMap.at({x, z - 1});
-                    Chunk* pZ = nullptr;
-                    if (!chunkMap.contains({x, z + 1})) {
-                        chunkMap.emplace(std::make_pair(x, z + 1), Chunk(x, z + 1));
+            }
+            storages[s].compact();
+        }
+        setNanoseconds = nanoseconds(start);
+
+        start = Clock::now();
+        for (const auto& storage : storages) {
+            for (int x = 0; x < SECTION_SIZE; ++x) {
+                for (int z = 0; z < SECTION_SIZE; ++z) {
+                    for (int y = 0; y < SECTION_SIZE; ++y) {
+                        sum += storage.get(x, y, z);
                     }
-                    pZ = &chunkMap.at({x, z + 1});
-                    //chunka->generateChunkData(x, z, pX, nX, pZ, nZ);
-                    threads.emplace_back([chunka, x, z, nX, pX, nZ, pZ]() {
-                        chunka->generateChunkData(x, z, pX, nX, pZ, nZ);
-                    });
-                    continue;
                 }
-                combinedDeta.insert(std::end(combinedDeta), std::begin(chunka->combinedData), std::end(chunka->combinedData));
-                chunkRendered++;
             }
         }
-        combinedData = combinedDeta;
+        getNanoseconds = nanoseconds(start);
+
+        start = Clock::now();
+        for (const auto& storage : storages) {
+            storage.unpack(unpacked.data());
+            sum += unpacked[sum % Flat::VOLUME];
+        }
+        unpackNanoseconds = nanoseconds(start);
+
+        for (const auto& storage : storages) {
+            bytes += storage.memoryUsage();
+        }
+    };
+
+    std::vector<Flat> flat(sections.size());
+    run(flat, result.flatSetNanoseconds, result.flatGetNanoseconds, result.flatUnpackNanoseconds, result.flatBytes, checksum[0]);
+    flat.clear();
+    std::vector<Palette> palette(sections.size());
+    run(palette, result.paletteSetNanoseconds, result.paletteGetNanoseconds, result.paletteUnpackNanoseconds, result.paletteBytes,
+        checksum[1]);
+    if (checksum[0] != checksum[1]) {
+        std::cout << "Section storage benchmark: flat and palette layouts disagree\n";
+    }
+    return result;
+}
+
+// Inserts, finds and erases the same chunk positions in a std::map and a ChunkIndex on the calling thread, for a
+// square of 1k, 10k and 100k chunks. Positions go in shuffled, and every find looks up a chunk and its four
+// neighbours, so the edge of the square also times some misses. Values are empty chunk pointers, the same size as
+// the chunk map's.
+std::vector<ChunkIndexBenchmarkResult> benchmarkChunkIndex() {
+    using Clock = std::chrono::steady_clock;
+    auto nanoseconds = [](Clock::time_point start, std::size_t operations) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(operations);
+    };
+
+    std::vector<ChunkIndexBenchmarkResult> results;
+    for (std::size_t count : {1000, 10000, 100000}) {
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        std::vector<ChunkPosition> positions;
+        for (std::size_t i = 0; i < count; ++i) {
+            positions.emplace_back(static_cast<int>(i) % side - side / 2, static_cast<int>(i) / side - side / 2);
+        }
+        std::shuffle(positions.begin(), positions.end(), std::mt19937(static_cast<std::uint32_t>(count)));
+
+        ChunkIndexBenchmarkResult result;
+        result.chunks = count;
+        std::size_t mapFound = 0, indexFound = 0; // Used, so the lookups aren't optimised away
+
+        std::map<ChunkPosition, std::shared_ptr<Chunk>> map;
+        auto start = Clock::now();
+        for (const ChunkPosition& position : positions) {
+            map.emplace(position, nullptr);
+        }
+        result.mapInsertNanoseconds = nanoseconds(start, count);
+        start = Clock::now();
+        for (const auto& [x, z] : positions) {
+            for (const ChunkPosition& position : {ChunkPosition(x, z), ChunkPosition(x + 1, z), ChunkPosition(x - 1, z),
+                                                  ChunkPosition(x, z + 1), ChunkPosition(x, z - 1)}) {
+                mapFound += map.find(position) != map.end();
+            }
+        }
+        result.mapFindNanoseconds = nanoseconds(start, count * 5);
+        start = Clock::now();
+        for (const ChunkPosition& position : positions) {
+            map.erase(position);
+        }
+        result.mapEraseNanoseconds = nanoseconds(start, count);
 
-        chunkLoadingInProgress = false;  // Reset flag when done
-    }).detach();  // Detach the thread to run in the background
+        ChunkIndex<std::shared_ptr<Chunk>> index;
+        start = Clock::now();
+        for (const ChunkPosition& position : positions) {
+            index.emplace(position, nullptr);
+        }
+        result.indexInsertNanoseconds = nanoseconds(start, count);
+        start = Clock::now();
+        for (const auto& [x, z] : positions) {
+            for (const ChunkPosition& position : {ChunkPosition(x, z), ChunkPosition(x + 1, z), ChunkPosition(x - 1, z),
+                                                  ChunkPosition(x, z + 1), ChunkPosition(x, z - 1)}) {
+                indexFound += index.find(position) != index.end();
+            }
+        }
+        result.indexFindNanoseconds = nanoseconds(start, count * 5);
+        start = Clock::now();
+        for (const ChunkPosition& position : positions) {
+            index.erase(position);
+        }
+        result.indexEraseNanoseconds = nanoseconds(start, count);
+
+        if (mapFound != indexFound || !map.empty() || !index.empty()) {
+            std::cout << "Chunk index benchmark: std::map and ChunkIndex disagree\n";
+        }
+        results.push_back(result);
+    }
+    return results;
 }
 
+// The flight the prefetch benchmark replays when no path was recorded, at three times the camera's speed: straight
+// along +X, a turn to fly along +Z, then back and forth over a chunk border every half second
+CameraPath testFlight() {
+    const float speed = 3.0f * SPEED;
+    const glm::vec3 east(1.0f, 0.0f, 0.0f), south(0.0f, 0.0f, 1.0f);
+    CameraPath path;
+    glm::vec3 position(8.0f, 80.0f, 8.0f);
+    path.add(0.0f, position, east);
+    position += east * speed * 3.0f;
+    path.add(3.0f, position, east);
+    path.add(3.5f, position, south);
+    position += south * speed * 3.0f;
+    path.add(6.5f, position, south);
+    const float border = std::ceil(position.z / CHUNK_SIZE_Z) * CHUNK_SIZE_Z;
+    for (int i = 0; i < 8; ++i) {
+        path.add(7.0f + 0.5f * static_cast<float>(i), glm::vec3(position.x, position.y, border + (i % 2 == 0 ? 4.0f : -4.0f)), south);
+    }
+    return path;
+}
 
+// Replays path with a chunk map and pipeline of its own, once loading only around the camera's chunk the way the game
+// did before prefetching and once with prefetching and unload slack, and counts holes: chunks within render distance
+// and in view that have no geometry yet. Frames run at 60 a second in real time on the calling thread, uploads and
+// unloads happen right in the frame. Both runs start once everything in view at the start of the path is meshed.
+// Chunks are always generated, the world store isn't touched. Takes as long as the path plus the warm-up, so the
+// game runs it on a thread of its own; everything it reads from the game is passed in. Setting stop ends it early
+// with what was measured so far.
+std::vector<PrefetchBenchmarkResult> benchmarkPrefetch(CameraPath path, glm::mat4 projection, MeshingMode mode,
+                                                       const std::atomic<bool>& stop) {
+    using Clock = std::chrono::steady_clock;
+    constexpr double FRAME_SECONDS = 1.0 / 60.0;
+    constexpr double WARM_UP_SECONDS = 20.0; // Gives up waiting for the start to be meshed after this
+    struct Policy {
+        const char* name;
+        int ahead, slack, keepRadius;
+    };
+    const Policy policies[] = {{"Camera chunk only", 0, 0, renderDistance + 2},
+                               {"Prefetch", prefetchDistance, unloadSlack, cleanupRadius}};
+
+    std::vector<PrefetchBenchmarkResult> results;
+    for (const Policy& policy : policies) {
+        ChunkMap chunks;
+        std::mutex mutex;
+        ChunkPipeline pipeline(chunks, mutex, jobSystem, policy.keepRadius);
+        ChunkPrefetch prefetch(policy.ahead, policy.slack, prefetchSeconds);
+        ChunkWindow<bool> meshed(policy.keepRadius); // Chunks with geometry, like chunkSlices
+        std::vector<ChunkPosition> leftWindow;
+        PrefetchBenchmarkResult result;
+        result.policy = policy.name;
+
+        // One frame of the main loop without drawing, returns the holes in it
+        auto frame = [&](double seconds) {
+            const CameraKeyframe view = path.sample(static_cast<float>(seconds));
+            prefetch.update(view.position, seconds);
+            const ChunkFocus& focus = prefetch.focus();
+            const Frustum frustum = Frustum::fromMatrix(projection * glm::lookAt(view.position, view.position + view.front, glm::vec3(0.0f, 1.0f, 0.0f)));
+            pipeline.update(focus, renderDistance, mode, view.position, &frustum);
+
+            meshed.recenter(focus.anchor.first, focus.anchor.second, [&](ChunkPosition position, bool*) {
+                leftWindow.push_back(position);
+            });
+            if (!leftWindow.empty()) {
+                std::vector<ChunkPosition> retry;
+                std::lock_guard<std::mutex> lock(mutex);
+                chunks.update([&](ChunkMap::Writer& writer) {
+                    for (const ChunkPosition& position : leftWindow) {
+                        auto it = writer.view().find(position);
+                        if (it == writer.view().end()) {
+                            continue;
+                        }
+                        if (meshed.contains(position.first, position.second)) {
+                            if (it->second->stage == ChunkStage::Uploaded) {
+                                pipeline.markUnmeshed(*it->second);
+                            }
+                            continue;
+                        }
+                        if (it->second->jobRefs > 0) {
+                            retry.push_back(position);
+                            continue;
+                        }
+                        unloadChunk(writer, position, *it->second);
+                        result.unloads++;
+                    }
+                });
+                leftWindow.swap(retry);
+            }
+
+            const std::shared_ptr<const ChunkMap::Entries> loaded = chunks.snapshot();
+            for (const ChunkMesh& mesh : pipeline.takeMeshes()) {
+                auto chunk = loaded->find({mesh.chunkX, mesh.chunkZ});
+                if (chunk == loaded->end() || ChunkMap::handle(*chunk->second) != mesh.chunk) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!meshed.contains(mesh.chunkX, mesh.chunkZ)) {
+                    pipeline.markUnmeshed(*chunk->second);
+                    continue;
+                }
+                meshed.emplace(mesh.chunkX, mesh.chunkZ) = true;
+                pipeline.markUploaded(*chunk->second, mesh, 0.0, false);
+            }
+
+            std::size_t holes = 0;
+            for (int x = focus.current.first - renderDistance; x <= focus.current.first + renderDistance; x++) {
+                for (int z = focus.current.second - renderDistance; z <= focus.current.second + renderDistance; z++) {
+                    const glm::vec3 origin(x * CHUNK_SIZE_X - 0.5f, -0.5f, z * CHUNK_SIZE_Z - 0.5f);
+                    if (frustum.intersects(origin, origin + glm::vec3(CHUNK_SIZE_X, CHUNK_SIZE_Y, CHUNK_SIZE_Z)) && !meshed.find(x, z)) {
+                        holes++;
+                    }
+                }
+            }
+            return holes;
+        };
+
+        // Path time stands still while warming up and moves a frame at a time afterwards, however long frames take
+        Clock::time_point start = Clock::now();
+        while (!stop && frame(0.0) > 0 && std::chrono::duration<double>(Clock::now() - start).count() < WARM_UP_SECONDS) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(FRAME_SECONDS));
+        }
+        start = Clock::now();
+        for (std::size_t n = 1; !stop && static_cast<double>(n) * FRAME_SECONDS <= path.duration(); ++n) {
+            const double seconds = static_cast<double>(n) * FRAME_SECONDS;
+            const std::size_t holes = frame(seconds);
+            result.holesPerSecond += static_cast<double>(holes);
+            result.maxHoles = std::max(result.maxHoles, holes);
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)));
+        }
+        result.seconds = path.duration();
+        result.holesPerSecond /= std::max(result.seconds, FRAME_SECONDS);
+
+        pipeline.drain();
+        const std::array<ChunkStageStats, CHUNK_STAGE_COUNT> stages = pipeline.stats();
+        result.generated = stages[static_cast<int>(ChunkStage::Terrain)].completed;
+        for (const ChunkStageStats& stage : stages) {
+            result.cancelled += stage.cancelled;
+        }
+        results.push_back(result);
+    }
+    return results;
+}
 
 int main()
 {
@@ -380,17 +903,19 @@ int main()
 
     Shader shaderGay("../shaders/Gay.vert", "../shaders/Gay.frag");
     Shader shaderLight("../shaders/Light.vert", "../shaders/Light.frag");
+    const Uniform<glm::vec2> chunkOffset = shaderGay.uniform<glm::vec2>("chunkOffset"); // Set once per draw
 
-    glEnable(GL_DEPTH_TEST);
+    RenderState& state = renderState();
+    state.enable(GL_DEPTH_TEST);
 
 
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable( GL_BLEND );
-    glEnable(GL_CULL_FACE); // Enable face culling
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.enable(GL_BLEND);
+    state.enable(GL_CULL_FACE); // Enable face culling
     glCullFace(GL_BACK);    // Cull back-facing triangles
     glFrontFace(GL_CW);    // Set counter-clockwise vertices as the front face
 
@@ -472,9 +997,26 @@ int main()
 
     InGameHUD hud(SCR_WIDTH, SCR_HEIGHT, hudTexture);
 
+    // Every chunk's faces, each chunk in its own slice that is written once per meshing
+    GLVertexHeapBackend heapBackend;
+    VertexHeap vertexHeap(heapBackend, 4 * 1024 * 1024, sizeof(PackedFace));
+    glBindVertexArray(VAO1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+    const std::uint32_t atlasSampler = state.sampler(ATLAS_SAMPLER); // Replaces setting the texture's parameters every frame
+    CameraPath recordedPath;                 // Replayed by the prefetch benchmark
+    bool recordingCamera = false;            // The previous frame recorded, a new recording starts once this turns on
+    double recordingStartedAt = 0.0;
+    std::future<std::vector<PrefetchBenchmarkResult>> prefetchBenchmark; // Valid while it runs
+    std::atomic<bool> stopPrefetchBenchmark{false};
+
     while (!glfwWindowShouldClose(window)) {
+        state.beginFrame();
         glm::vec2 chunkPosition = glm::vec2(floor(camera.Position.x / 16), floor(camera.Position.z / 16));
-        cleanupChunksAsync(chunkPosition, chunkMap, renderedChunks, cleanupRadius);
+        chunkPrefetch.update(camera.Position, glfwGetTime());
+        const ChunkFocus focus = chunkPrefetch.focus();
+        cleanupChunksAsync(focus.anchor, chunkMap, cleanupRadius);
         glfwPollEvents();
         processInput(window);
         glfwSetCursorPosCallback(window, mouse_callback);
@@ -493,7 +1035,7 @@ int main()
         model = glm::translate(model, camera.Position);;
 
         shaderLight.use();
-        glBindVertexArray(lightCubeVAO);
+        state.bindVertexArray(lightCubeVAO);
         shaderLight.setMat4("view", view);
         shaderLight.setMat4("projection", projection);
         shaderLight.setMat4("model", model);
@@ -505,63 +1047,86 @@ int main()
         shaderGay.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
         shaderGay.setVec3("lightPos", camera.Position);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glBindVertexArray(VAO1);
+        state.bindTexture(0, GL_TEXTURE_2D, texture);
+        state.bindTexture(1, GL_TEXTURE_2D, texture);
+        state.bindSampler(0, atlasSampler);
+        state.bindSampler(1, atlasSampler);
+        state.bindVertexArray(VAO1);
 
         shaderGay.setInt("ourTexture", 0);
         shaderGay.setInt("topTexture", 1);
         shaderGay.setVec4("tintColor", grassTint);
 
-        if (!chunkLoadingInProgress) {
-            loadChunksAsync(chunkPosition, chunkMap, renderedChunks, renderDistance);
-            glDeleteBuffers(1, &instanceVBOla);
-            glGenBuffers(1, &instanceVBOla);
-
-            glBindBuffer(GL_ARRAY_BUFFER, instanceVBOla);
-            glBufferData(GL_ARRAY_BUFFER, combinedData.size() * sizeof(float), combinedData.data(), GL_STATIC_DRAW);
-            constexpr GLsizei stride = (2 + 2 + 16 + 3) * sizeof(float);
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, static_cast<void *>(nullptr));
-            glVertexAttribDivisor(2, 1);
-
-            glEnableVertexAttribArray(3);
-            glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(sizeof(float) * 2));
-            glVertexAttribDivisor(3, 1);
-
-            glEnableVertexAttribArray(4);
-            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(sizeof(float) * 4));
-            glVertexAttribDivisor(4, 1);
-
-            glEnableVertexAttribArray(5);
-            glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(sizeof(float) * 8));
-            glVertexAttribDivisor(5, 1);
-
-            glEnableVertexAttribArray(6);
-            glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(sizeof(float) * 12));
-            glVertexAttribDivisor(6, 1);
-
-            glEnableVertexAttribArray(7);
-            glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(sizeof(float) * 16));
-            glVertexAttribDivisor(7, 1);
-
-            glEnableVertexAttribArray(8);
-            glVertexAttribPointer(8, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(sizeof(float) * 20));
-            glVertexAttribDivisor(8, 1);
+        const Frustum frustum = Frustum::fromMatrix(projection * view);
+        chunkPipeline.update(focus, renderDistance, meshingMode, camera.Position, &frustum);
+        flushChunkUploads(vertexHeap, focus.anchor.first, focus.anchor.second, frustum);
+
+        // One instanced draw per run of visible sections, pointing attribute 2 at the run inside the chunk's slice of the vertex heap
+        state.bindBuffer(GL_ARRAY_BUFFER, vertexHeap.buffer());
+        for (const ChunkDraw& draw : cullChunkSlices(frustum, camera.Position, hud.cullingStats)) {
+            const VertexHeapAllocation& slice = chunkSlices.find(draw.position.first, draw.position.second)->allocation;
+            shaderGay.set(chunkOffset, glm::vec2(draw.position.first * CHUNK_SIZE_X, draw.position.second * CHUNK_SIZE_Z));
+            glVertexAttribIPointer(2, 2, GL_UNSIGNED_INT, sizeof(PackedFace), reinterpret_cast<void *>(slice.offset + draw.firstFace * sizeof(PackedFace)));
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(draw.faceCount));
         }
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, combinedData.size() / 21);
-
-        glBindVertexArray(0);
-
+        // Unbound again so the heap never deletes a bound buffer when it grows, which would leave the tracker
+        // believing a buffer name is bound that GL may hand out again
+        state.bindBuffer(GL_ARRAY_BUFFER, 0);
+
+        hud.vertexHeapStats = vertexHeap.stats();
+        hud.jobSystemStats = jobSystem.stats();
+        hud.chunkStageStats = chunkPipeline.stats();
+        hud.firstGeometryStats = chunkPipeline.firstGeometryStats();
+        hud.chunkFocus = focus;
+        hud.cameraVelocity = chunkPrefetch.velocity();
+        hud.surfaceCacheStats = surfaceCache.stats();
+        hud.worldStoreStats = worldStore.stats();
+        hud.chunkMapStats = chunkMap.stats();
+        hud.uniformStats = shaderGay.uniformStats();
+        hud.uniformStats += shaderLight.uniformStats();
+        hud.renderStateStats = state.lastFrame();
         hud.RenderHUD(camera.Position, chunkPosition);
+        meshingMode = hud.greedyMeshing ? MeshingMode::Greedy : MeshingMode::PerFace;
+        if (hud.meshBenchmarkRequested) {
+            hud.meshBenchmarkResults = benchmarkMeshing();
+            hud.meshBenchmarkRequested = false;
+        }
+        if (hud.caveComparisonRequested) {
+            hud.caveComparison = compareCaveSampling();
+            hud.caveComparisonRequested = false;
+        }
+        if (hud.storageBenchmarkRequested) {
+            hud.storageBenchmark = benchmarkStorage();
+            hud.storageBenchmarkRequested = false;
+        }
+        if (hud.sectionStorageBenchmarkRequested) {
+            hud.sectionStorageBenchmark = benchmarkSectionStorage();
+            hud.sectionStorageBenchmarkRequested = false;
+        }
+        if (hud.chunkIndexBenchmarkRequested) {
+            hud.chunkIndexBenchmarkResults = benchmarkChunkIndex();
+            hud.chunkIndexBenchmarkRequested = false;
+        }
+        if (hud.recordingCameraPath) {
+            if (!recordingCamera) {
+                recordedPath.clear();
+                recordingStartedAt = glfwGetTime();
+                recordingCamera = true;
+            }
+            recordedPath.add(static_cast<float>(glfwGetTime() - recordingStartedAt), camera.Position, camera.Front);
+        } else {
+            recordingCamera = false;
+        }
+        hud.cameraPathSeconds = recordedPath.duration();
+        // Runs for many seconds, on its own thread rather than a worker since it mostly sleeps between its frames
+        if (hud.prefetchBenchmarkRequested && !prefetchBenchmark.valid()) {
+            prefetchBenchmark = std::async(std::launch::async, benchmarkPrefetch, recordedPath.empty() ? testFlight() : recordedPath,
+                                           projection, meshingMode.load(), std::cref(stopPrefetchBenchmark));
+        }
+        if (prefetchBenchmark.valid() && prefetchBenchmark.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            hud.prefetchBenchmarkResults = prefetchBenchmark.get();
+            hud.prefetchBenchmarkRequested = false;
+        }
 
         glfwSwapBuffers(window);
     }
@@ -570,12 +1135,20 @@ int main()
     glDeleteBuffers(1, &VBO1);
 
 
-    // Cleanup
-    for (auto& thread : threads) {
-        if (thread.joinable()) {
-            thread.join();
+    // Cleanup. The prefetch benchmark's pipeline needs the job system until it returns.
+    if (prefetchBenchmark.valid()) {
+        stopPrefetchBenchmark = true;
+        prefetchBenchmark.wait();
+    }
+    jobSystem.shutdown();
+    for (const auto& [position, chunk] : *chunkMap.snapshot()) {
+        if (chunk->dirty && chunk->stage >= ChunkStage::Decorated) {
+            std::vector<std::uint8_t> data;
+            chunk->serialize(data);
+            worldStore.save(position.first, position.second, std::move(data));
         }
     }
+    worldStore.shutdown();
 
     glfwTerminate();
     ImGui_ImplOpenGL3_Shutdown();
@@ -0,0 +1,193 @@
+#ifndef PALETTE_STORAGE_H
+#define PALETTE_STORAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "chunk_storage.h"
+
+// Palette compressed block storage: every voxel holds an index into a small per-storage palette of BlockIDs,
+// bit packed at 1, 2, 4, 8 or 16 bits per voxel. All widths divide 64, so no index ever straddles two words.
+// The width grows automatically when the palette fills up and shrinks again in compact().
+template <int SizeX, int SizeY, int SizeZ, ChunkLayout Layout = ChunkLayout::XZY>
+class PaletteStorage {
+public:
+    using Flat = ChunkStorage<SizeX, SizeY, SizeZ, Layout>;
+    static constexpr int VOLUME = Flat::VOLUME;
+    static constexpr ChunkLayout LAYOUT = Layout;
+    static_assert(VOLUME % 64 == 0, "Volume must fill whole 64-bit words");
+
+    PaletteStorage() {
+        fill(BlockIds::AIR);
+    }
+
+    static constexpr int index(int x, int y, int z) {
+        return Flat::index(x, y, z);
+    }
+
+    BlockID get(int x, int y, int z) const {
+        return palette[readIndex(index(x, y, z))];
+    }
+
+    void set(int x, int y, int z, BlockID id) {
+        writeIndex(index(x, y, z), paletteIndexOf(id));
+    }
+
+    void fill(BlockID id) {
+        palette.assign(1, id);
+        resize(0);
+    }
+
+    // Decodes every voxel in storage order into out[0..VOLUME), much faster than VOLUME calls to get()
+    void unpack(BlockID* out) const {
+        const int perWord = 64 >> bitsLog2;
+        const std::uint64_t mask = entryMask();
+        for (std::size_t w = 0; w < words.size(); ++w) {
+            std::uint64_t word = words[w];
+            for (int i = 0; i < perWord; ++i) {
+                *out++ = palette[word & mask];
+                word >>= bits();
+            }
+        }
+    }
+
+    // True if every voxel refers to the same palette entry, which is written to id
+    bool isUniform(BlockID& id) const {
+        std::size_t used = 0;
+        std::size_t lastUsed = 0;
+        forEachUsedEntry([&](std::size_t entry) {
+            ++used;
+            lastUsed = entry;
+        });
+        id = palette[lastUsed];
+        return used == 1;
+    }
+
+    // Drops palette entries no voxel refers to any more and repacks at the narrowest width that still fits
+    void compact() {
+        std::vector<std::uint16_t> remap(palette.size(), 0);
+        std::vector<BlockID> compacted;
+        forEachUsedEntry([&](std::size_t entry) {
+            remap[entry] = static_cast<std::uint16_t>(compacted.size());
+            compacted.push_back(palette[entry]);
+        });
+        if (compacted.size() == palette.size()) return;
+
+        int newLog2 = 0;
+        while ((std::size_t{1} << (1 << newLog2)) < compacted.size()) ++newLog2;
+        repack(newLog2, remap);
+        palette = std::move(compacted);
+    }
+
+    int bitsPerBlock() const {
+        return bits();
+    }
+
+    std::size_t paletteSize() const {
+        return palette.size();
+    }
+
+    std::size_t memoryUsage() const {
+        return sizeof(*this) + words.capacity() * sizeof(std::uint64_t) + palette.capacity() * sizeof(BlockID);
+    }
+
+    // The packed representation as is, for saving: 2^bitsLog2 bits per voxel, words in storage order
+    int packedBitsLog2() const {
+        return bitsLog2;
+    }
+
+    const std::vector<BlockID>& packedPalette() const {
+        return palette;
+    }
+
+    const std::vector<std::uint64_t>& packedWords() const {
+        return words;
+    }
+
+    // Counterpart of the packed accessors for loading. packedWords has to hold VOLUME * 2^newBitsLog2 / 64 words
+    // and every index in it has to be inside newPalette, returns false and leaves the storage unchanged otherwise.
+    bool assignPacked(int newBitsLog2, std::vector<BlockID> newPalette, const std::uint64_t* packedWords) {
+        if (newBitsLog2 < 0 || newBitsLog2 > MAX_BITS_LOG2 || newPalette.empty() ||
+            newPalette.size() > (std::size_t{1} << (1 << newBitsLog2))) {
+            return false;
+        }
+        const int newBits = 1 << newBitsLog2;
+        const std::uint64_t mask = (std::uint64_t{1} << newBits) - 1;
+        const std::size_t wordCount = static_cast<std::size_t>(VOLUME) * newBits / 64;
+        for (std::size_t w = 0; w < wordCount; ++w) {
+            std::uint64_t word = packedWords[w];
+            for (int i = 0; i < 64 / newBits; ++i, word >>= newBits) {
+                if ((word & mask) >= newPalette.size()) return false;
+            }
+        }
+        bitsLog2 = newBitsLog2;
+        palette = std::move(newPalette);
+        words.assign(packedWords, packedWords + wordCount);
+        return true;
+    }
+
+private:
+    static constexpr int MAX_BITS_LOG2 = 4; // 16 bits, enough for every possible BlockID
+
+    std::vector<std::uint64_t> words;
+    std::vector<BlockID> palette;
+    int bitsLog2 = 0;
+
+    int bits() const {
+        return 1 << bitsLog2;
+    }
+
+    std::uint64_t entryMask() const {
+        return (std::uint64_t{1} << bits()) - 1;
+    }
+
+    std::uint32_t readIndex(int i) const {
+        const int shift = (i & ((64 >> bitsLog2) - 1)) << bitsLog2;
+        return static_cast<std::uint32_t>((words[i >> (6 - bitsLog2)] >> shift) & entryMask());
+    }
+
+    void writeIndex(int i, std::uint32_t value) {
+        const int shift = (i & ((64 >> bitsLog2) - 1)) << bitsLog2;
+        std::uint64_t& word = words[i >> (6 - bitsLog2)];
+        word = (word & ~(entryMask() << shift)) | (std::uint64_t{value} << shift);
+    }
+
+    std::uint32_t paletteIndexOf(BlockID id) {
+        for (std::size_t i = 0; i < palette.size(); ++i) {
+            if (palette[i] == id) return static_cast<std::uint32_t>(i);
+        }
+        if (palette.size() == (std::size_t{1} << bits()) && bitsLog2 < MAX_BITS_LOG2) {
+            std::vector<std::uint16_t> identity(palette.size());
+            for (std::size_t i = 0; i < identity.size(); ++i) identity[i] = static_cast<std::uint16_t>(i);
+            repack(bitsLog2 + 1, identity);
+        }
+        palette.push_back(id);
+        return static_cast<std::uint32_t>(palette.size() - 1);
+    }
+
+    void resize(int newLog2) {
+        bitsLog2 = newLog2;
+        words.assign(static_cast<std::size_t>(VOLUME) * bits() / 64, 0);
+    }
+
+    // Re-encodes every voxel at 2^newLog2 bits, mapping old palette indices through remap
+    void repack(int newLog2, const std::vector<std::uint16_t>& remap) {
+        std::vector<std::uint32_t> indices(VOLUME);
+        for (int i = 0; i < VOLUME; ++i) indices[i] = remap[readIndex(i)];
+        resize(newLog2);
+        for (int i = 0; i < VOLUME; ++i) writeIndex(i, indices[i]);
+    }
+
+    // Calls fn once for every palette entry that at least one voxel refers to, in palette order
+    template <typename Fn>
+    void forEachUsedEntry(Fn fn) const {
+        std::vector<bool> used(palette.size(), false);
+        for (int i = 0; i < VOLUME; ++i) used[readIndex(i)] = true;
+        for (std::size_t entry = 0; entry < used.size(); ++entry) {
+            if (used[entry]) fn(entry);
+        }
+    }
+};
+
+#endif // PALETTE_STORAGE_H
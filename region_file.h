@@ -0,0 +1,204 @@
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr int REGION_SIZE = 32; // Chunks along x and z in one region file
+// A region file is rewritten without dead records once they take up more than the live ones and at least this much
+constexpr std::size_t REGION_COMPACT_MIN_DEAD_BYTES = 256 * 1024;
+
+// Up to REGION_SIZE x REGION_SIZE chunks in one file. The file starts with a header, the magic, the format version
+// and one {offset, size} entry per chunk at index z * REGION_SIZE + x, followed by the chunk records. Offset 0 means
+// the chunk was never saved. Records are only ever appended: saving a chunk again writes a new record and leaves the
+// old one as dead space, until there is more dead space than live records and the file is compacted. Reads go through
+// a read only memory mapping of the whole file, remapped after every write.
+class RegionFile {
+public:
+    // Opens the region file at path, creating it if it does not exist yet. Null if it can't be opened or isn't a
+    // region file.
+    static std::unique_ptr<RegionFile> open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            return nullptr;
+        }
+        std::unique_ptr<RegionFile> file(new RegionFile(fd, path));
+        struct stat status{};
+        if (fstat(fd, &status) != 0) {
+            return nullptr;
+        }
+        if (status.st_size == 0) {
+            Header header{};
+            std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+            header.version = VERSION;
+            if (pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                return nullptr;
+            }
+            file->header = header;
+            file->size = sizeof(header);
+        } else {
+            file->size = static_cast<std::size_t>(status.st_size);
+            if (file->size < sizeof(Header) || pread(fd, &file->header, sizeof(Header), 0) != static_cast<ssize_t>(sizeof(Header)) ||
+                std::memcmp(file->header.magic, MAGIC, sizeof(file->header.magic)) != 0 || file->header.version != VERSION) {
+                return nullptr;
+            }
+            for (const Entry& entry : file->header.entries) {
+                file->liveBytes += entry.offset != 0 ? entry.size : 0;
+            }
+        }
+        return file->map() ? std::move(file) : nullptr;
+    }
+
+    ~RegionFile() {
+        unmap();
+        ::close(fd);
+    }
+
+    RegionFile(const RegionFile&) = delete;
+    RegionFile& operator=(const RegionFile&) = delete;
+
+    // Calls fn(data, size) with the stored record of a chunk straight from the mapping and returns its result, false
+    // without calling fn if the chunk isn't in the file. Writes wait until fn returns.
+    template <typename Fn>
+    bool read(int localX, int localZ, Fn&& fn) {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        const Entry entry = header.entries[localZ * REGION_SIZE + localX];
+        if (entry.offset == 0 || static_cast<std::size_t>(entry.offset) + entry.size > mappedSize) {
+            return false;
+        }
+        return fn(mapping + entry.offset, static_cast<std::size_t>(entry.size));
+    }
+
+    // Appends a record for the chunk and points its entry at it, compacting the file if that leaves too much dead space
+    bool write(int localX, int localZ, const std::uint8_t* data, std::size_t bytes) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        Entry& entry = header.entries[localZ * REGION_SIZE + localX];
+        const Entry written{static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(bytes)};
+        // Record first, entry second, so a crash in between only loses this save
+        if (pwrite(fd, data, bytes, static_cast<off_t>(size)) != static_cast<ssize_t>(bytes) ||
+            pwrite(fd, &written, sizeof(written), static_cast<off_t>(offsetof(Header, entries) + (&entry - header.entries) * sizeof(Entry))) !=
+                static_cast<ssize_t>(sizeof(written))) {
+            return false;
+        }
+        liveBytes += bytes - (entry.offset != 0 ? entry.size : 0);
+        entry = written;
+        size += bytes;
+        unmap();
+        if (!map()) {
+            return false;
+        }
+        const std::size_t deadBytes = size - sizeof(Header) - liveBytes;
+        if (deadBytes >= REGION_COMPACT_MIN_DEAD_BYTES && deadBytes > liveBytes) {
+            compact(); // The record is saved either way, a failed compaction leaves the file as it was
+        }
+        return true;
+    }
+
+    std::size_t fileSize() {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return size;
+    }
+
+    // Bytes of the records that are still pointed at
+    std::size_t liveSize() {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return liveBytes;
+    }
+
+    std::uint64_t compactions() {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return compactionCount;
+    }
+
+private:
+    static constexpr char MAGIC[4] = {'R', 'G', 'N', 'F'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    struct Entry {
+        std::uint32_t offset;
+        std::uint32_t size;
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        Entry entries[REGION_SIZE * REGION_SIZE];
+    };
+
+    int fd;
+    const std::string path;
+    Header header{};
+    std::size_t size = 0;      // Bytes in the file
+    std::size_t liveBytes = 0; // Of those, records an entry points at
+    std::uint64_t compactionCount = 0;
+    std::uint8_t* mapping = nullptr;
+    std::size_t mappedSize = 0;
+    std::shared_mutex mutex;
+
+    RegionFile(int fd, std::string path) : fd(fd), path(std::move(path)) {}
+
+    // Writes the live records back to back into a new file next to this one and renames it over this one, so a
+    // crash leaves either the old or the new file. Called with the mutex held exclusively and the file mapped.
+    bool compact() {
+        const std::string compactedPath = path + ".compact";
+        const int compactedFd = ::open(compactedPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (compactedFd < 0) {
+            return false;
+        }
+        Header compacted = header;
+        std::size_t offset = sizeof(Header);
+        bool written = true;
+        for (Entry& entry : compacted.entries) {
+            if (entry.offset == 0) continue;
+            written = written && pwrite(compactedFd, mapping + entry.offset, entry.size, static_cast<off_t>(offset)) ==
+                                     static_cast<ssize_t>(entry.size);
+            entry.offset = static_cast<std::uint32_t>(offset);
+            offset += entry.size;
+        }
+        written = written && pwrite(compactedFd, &compacted, sizeof(compacted), 0) == static_cast<ssize_t>(sizeof(compacted));
+        if (!written || std::rename(compactedPath.c_str(), path.c_str()) != 0) {
+            ::close(compactedFd);
+            std::remove(compactedPath.c_str());
+            return false;
+        }
+
+        unmap();
+        ::close(fd);
+        fd = compactedFd;
+        header = compacted;
+        size = offset;
+        compactionCount++;
+        return map();
+    }
+
+    bool map() {
+        void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            return false;
+        }
+        mapping = static_cast<std::uint8_t*>(address);
+        mappedSize = size;
+        return true;
+    }
+
+    void unmap() {
+        if (mapping) {
+            munmap(mapping, mappedSize);
+            mapping = nullptr;
+            mappedSize = 0;
+        }
+    }
+};
+
+#endif // REGION_FILE_H
@@ -0,0 +1,158 @@
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+// How a texture is sampled, kept in a sampler object instead of setting the texture's own parameters. Values are
+// the GL enums (GL_NEAREST, GL_CLAMP_TO_EDGE, ...).
+struct SamplerState {
+    std::uint32_t minFilter;
+    std::uint32_t magFilter;
+    std::uint32_t wrapS;
+    std::uint32_t wrapT;
+
+    bool operator<(const SamplerState& other) const {
+        return std::tie(minFilter, magFilter, wrapS, wrapT) < std::tie(other.minFilter, other.magFilter, other.wrapS, other.wrapT);
+    }
+};
+
+// What the state tracker needs from the graphics API, so it can run against a recording fake without a GL context.
+// Targets, capabilities and blend factors are GL enums, texture units are indices from 0.
+class RenderStateBackend {
+public:
+    virtual ~RenderStateBackend() = default;
+
+    virtual void useProgram(std::uint32_t program) = 0;
+    virtual void bindVertexArray(std::uint32_t vertexArray) = 0;
+    virtual void bindBuffer(std::uint32_t target, std::uint32_t buffer) = 0;
+    virtual void activeTexture(std::uint32_t unit) = 0;
+    virtual void bindTexture(std::uint32_t target, std::uint32_t texture) = 0; // On the active unit
+    virtual void bindSampler(std::uint32_t unit, std::uint32_t sampler) = 0;
+    virtual void setCapability(std::uint32_t capability, bool enabled) = 0;
+    virtual void blendFunc(std::uint32_t source, std::uint32_t destination) = 0;
+    virtual std::uint32_t createSampler(const SamplerState& state) = 0;
+};
+
+struct RenderStateStats {
+    std::uint64_t issued = 0; // Calls that reached the backend
+    std::uint64_t elided = 0; // Calls dropped because they would not have changed anything
+};
+
+// Tracks the bound program, vertex array, buffers, textures, samplers, capabilities and blend function, and only
+// forwards calls that change them. Starts out knowing nothing, so the first call for any piece of state always goes
+// through. Code that changes state behind its back has to call invalidate() afterwards; code that puts back what it
+// found, like the ImGui renderer, doesn't. Element array buffer bindings belong to the vertex array and are not
+// tracked.
+class RenderState {
+public:
+    explicit RenderState(RenderStateBackend& backend) : backend(backend) {}
+
+    RenderState(const RenderState&) = delete;
+    RenderState& operator=(const RenderState&) = delete;
+
+    void useProgram(std::uint32_t program) {
+        if (change(currentProgram, program)) backend.useProgram(program);
+    }
+
+    void bindVertexArray(std::uint32_t vertexArray) {
+        if (change(currentVertexArray, vertexArray)) backend.bindVertexArray(vertexArray);
+    }
+
+    void bindBuffer(std::uint32_t target, std::uint32_t buffer) {
+        if (change(buffers[target], buffer)) backend.bindBuffer(target, buffer);
+    }
+
+    // Binds texture on the given unit, switching the active unit only if the binding changes
+    void bindTexture(std::uint32_t unit, std::uint32_t target, std::uint32_t texture) {
+        if (!change(textures[{unit, target}], texture)) return;
+        if (activeUnit != unit) {
+            backend.activeTexture(unit);
+            activeUnit = unit;
+            frame.issued++;
+        }
+        backend.bindTexture(target, texture);
+    }
+
+    void bindSampler(std::uint32_t unit, std::uint32_t sampler) {
+        if (change(samplers[unit], sampler)) backend.bindSampler(unit, sampler);
+    }
+
+    void setCapability(std::uint32_t capability, bool enabled) {
+        if (change(capabilities[capability], enabled)) backend.setCapability(capability, enabled);
+    }
+
+    void enable(std::uint32_t capability) {
+        setCapability(capability, true);
+    }
+
+    void disable(std::uint32_t capability) {
+        setCapability(capability, false);
+    }
+
+    void blendFunc(std::uint32_t source, std::uint32_t destination) {
+        if (change(blend, std::make_pair(source, destination))) backend.blendFunc(source, destination);
+    }
+
+    // The sampler object for state, created on first use and kept for the tracker's lifetime
+    std::uint32_t sampler(const SamplerState& state) {
+        auto it = samplerObjects.find(state);
+        if (it == samplerObjects.end()) {
+            it = samplerObjects.emplace(state, backend.createSampler(state)).first;
+        }
+        return it->second;
+    }
+
+    // Forgets everything, the next call for any piece of state goes through
+    void invalidate() {
+        currentProgram.reset();
+        currentVertexArray.reset();
+        buffers.clear();
+        activeUnit.reset();
+        textures.clear();
+        samplers.clear();
+        capabilities.clear();
+        blend.reset();
+    }
+
+    // Starts counting a new frame, what was counted so far becomes lastFrame()
+    void beginFrame() {
+        previousFrame = frame;
+        frame = {};
+    }
+
+    RenderStateStats lastFrame() const {
+        return previousFrame;
+    }
+
+private:
+    RenderStateBackend& backend;
+    std::optional<std::uint32_t> currentProgram;
+    std::optional<std::uint32_t> currentVertexArray;
+    std::map<std::uint32_t, std::optional<std::uint32_t>> buffers; // By target
+    std::optional<std::uint32_t> activeUnit;
+    std::map<std::pair<std::uint32_t, std::uint32_t>, std::optional<std::uint32_t>> textures; // By unit and target
+    std::map<std::uint32_t, std::optional<std::uint32_t>> samplers; // By unit
+    std::map<std::uint32_t, std::optional<bool>> capabilities;
+    std::optional<std::pair<std::uint32_t, std::uint32_t>> blend;
+    std::map<SamplerState, std::uint32_t> samplerObjects;
+    RenderStateStats frame, previousFrame;
+
+    // Records value and counts the call, true if it has to reach the backend
+    template <typename T>
+    bool change(std::optional<T>& current, const T& value) {
+        if (current == value) {
+            frame.elided++;
+            return false;
+        }
+        current = value;
+        frame.issued++;
+        return true;
+    }
+};
+
+#endif // RENDER_STATE_H
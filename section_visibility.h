@@ -0,0 +1,161 @@
+#ifndef SECTION_VISIBILITY_H
+#define SECTION_VISIBILITY_H
+
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <utility>
+#include <glm/glm.hpp>
+#include "chunk_section.h"
+#include "face_format.h"
+
+constexpr int SECTION_VOLUME = SECTION_SIZE * SECTION_SIZE * SECTION_SIZE;
+
+constexpr FaceDirection oppositeFace(FaceDirection face) {
+    return static_cast<FaceDirection>(face ^ 1u); // The enum pairs every face with its opposite
+}
+static_assert(oppositeFace(FACE_NEG_Z) == FACE_POS_Z && oppositeFace(FACE_NEG_X) == FACE_POS_X && oppositeFace(FACE_POS_Y) == FACE_NEG_Y);
+
+// Which pairs of a section's six faces can see each other through the section, i.e. are joined by a path of
+// non-opaque blocks. Symmetric, one bit per ordered pair.
+struct SectionConnectivity {
+    std::uint64_t bits = 0;
+
+    static constexpr SectionConnectivity all() {
+        return {(std::uint64_t{1} << 36) - 1};
+    }
+
+    constexpr bool connects(FaceDirection a, FaceDirection b) const {
+        return (bits >> (a * 6 + b)) & 1;
+    }
+
+    constexpr void connect(FaceDirection a, FaceDirection b) {
+        bits |= std::uint64_t{1} << (a * 6 + b) | std::uint64_t{1} << (b * 6 + a);
+    }
+};
+
+// Flood fills the open (non-opaque) blocks of one section and connects every pair of faces the same open region
+// touches. open is indexed (x * SECTION_SIZE + z) * SECTION_SIZE + y, the order ChunkSection::unpack() uses. Fills
+// only start on the section's boundary, pockets that touch no face can't connect any.
+inline SectionConnectivity computeSectionConnectivity(const bool* open) {
+    constexpr int last = SECTION_SIZE - 1;
+    SectionConnectivity result;
+    std::bitset<SECTION_VOLUME> visited;
+    std::array<std::uint16_t, SECTION_VOLUME> stack;
+    for (int start = 0; start < SECTION_VOLUME; ++start) {
+        const int startY = start % SECTION_SIZE;
+        const int startZ = start / SECTION_SIZE % SECTION_SIZE;
+        const int startX = start / (SECTION_SIZE * SECTION_SIZE);
+        const bool boundary = startX == 0 || startX == last || startY == 0 || startY == last || startZ == 0 || startZ == last;
+        if (!boundary || !open[start] || visited[start]) {
+            continue;
+        }
+        std::uint32_t faces = 0; // Bit per FaceDirection the region touches
+        int size = 0;
+        stack[size++] = static_cast<std::uint16_t>(start);
+        visited[start] = true;
+        while (size > 0) {
+            const int index = stack[--size];
+            const int y = index % SECTION_SIZE;
+            const int z = index / SECTION_SIZE % SECTION_SIZE;
+            const int x = index / (SECTION_SIZE * SECTION_SIZE);
+            faces |= (x == 0) << FACE_NEG_X | (x == last) << FACE_POS_X | (y == 0) << FACE_NEG_Y | (y == last) << FACE_POS_Y |
+                     (z == 0) << FACE_NEG_Z | (z == last) << FACE_POS_Z;
+
+            const int neighbours[6] = {
+                x > 0 ? index - SECTION_SIZE * SECTION_SIZE : -1, x < last ? index + SECTION_SIZE * SECTION_SIZE : -1,
+                z > 0 ? index - SECTION_SIZE : -1, z < last ? index + SECTION_SIZE : -1,
+                y > 0 ? index - 1 : -1, y < last ? index + 1 : -1
+            };
+            for (int neighbour : neighbours) {
+                if (neighbour >= 0 && open[neighbour] && !visited[neighbour]) {
+                    visited[neighbour] = true;
+                    stack[size++] = static_cast<std::uint16_t>(neighbour);
+                }
+            }
+        }
+        for (int a = 0; a < 6; ++a) {
+            for (int b = a + 1; b < 6; ++b) {
+                if ((faces >> a & 1) && (faces >> b & 1)) {
+                    result.connect(static_cast<FaceDirection>(a), static_cast<FaceDirection>(b));
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Sections that may be visible from the camera, as a bit per section (bottom section in bit 0) for every chunk with
+// at least one
+using VisibleSections = std::map<std::pair<int, int>, std::uint32_t>;
+
+// Breadth first walk over sections starting at the camera's. A section is entered through one face and only left
+// through faces that face connects to, and the walk never steps against a direction it already took, so it only
+// spreads away from the camera. connectivity(chunkX, sectionY, chunkZ) returns null for sections the walk should not
+// enter, ones that aren't loaded or are outside the view. A camera above or below the world starts from the top or
+// bottom layer of every chunk within maxDistance chunks. Returns false if there was no section to start from, in
+// which case visible says nothing and everything has to be drawn.
+template <typename Lookup>
+bool findVisibleSections(glm::vec3 camera, int sectionsPerChunk, int maxDistance, Lookup&& connectivity, VisibleSections& visible) {
+    struct Step {
+        int chunkX, sectionY, chunkZ;
+        int enteredThrough;         // FaceDirection of this section the walk came in by, -1 for the camera's section
+        std::uint32_t directions;   // Bit per FaceDirection stepped along so far
+    };
+    constexpr int offsets[6][3] = {{0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, -1, 0}}; // By FaceDirection
+
+    visible.clear();
+    std::deque<Step> queue;
+    auto visit = [&](int chunkX, int sectionY, int chunkZ, int enteredThrough, std::uint32_t directions) {
+        if (sectionY < 0 || sectionY >= sectionsPerChunk || connectivity(chunkX, sectionY, chunkZ) == nullptr) {
+            return;
+        }
+        std::uint32_t& mask = visible[{chunkX, chunkZ}];
+        if (mask >> sectionY & 1) {
+            return;
+        }
+        mask |= 1u << sectionY;
+        queue.push_back({chunkX, sectionY, chunkZ, enteredThrough, directions});
+    };
+
+    const int cameraChunkX = static_cast<int>(std::floor((camera.x + 0.5f) / SECTION_SIZE));
+    const int cameraChunkZ = static_cast<int>(std::floor((camera.z + 0.5f) / SECTION_SIZE));
+    const int cameraSectionY = static_cast<int>(std::floor((camera.y + 0.5f) / SECTION_SIZE));
+    if (cameraSectionY >= 0 && cameraSectionY < sectionsPerChunk) {
+        visit(cameraChunkX, cameraSectionY, cameraChunkZ, -1, 0);
+    } else {
+        const bool above = cameraSectionY >= sectionsPerChunk;
+        for (int x = cameraChunkX - maxDistance; x <= cameraChunkX + maxDistance; ++x) {
+            for (int z = cameraChunkZ - maxDistance; z <= cameraChunkZ + maxDistance; ++z) {
+                visit(x, above ? sectionsPerChunk - 1 : 0, z, above ? FACE_POS_Y : FACE_NEG_Y, 1u << (above ? FACE_NEG_Y : FACE_POS_Y));
+            }
+        }
+    }
+
+    if (queue.empty()) {
+        return false;
+    }
+
+    while (!queue.empty()) {
+        const Step step = queue.front();
+        queue.pop_front();
+        const SectionConnectivity* section = connectivity(step.chunkX, step.sectionY, step.chunkZ);
+        for (int out = 0; out < 6; ++out) {
+            const auto face = static_cast<FaceDirection>(out);
+            if (step.directions >> oppositeFace(face) & 1) {
+                continue; // Would turn back towards the camera
+            }
+            if (step.enteredThrough >= 0 && !section->connects(static_cast<FaceDirection>(step.enteredThrough), face)) {
+                continue;
+            }
+            visit(step.chunkX + offsets[out][0], step.sectionY + offsets[out][1], step.chunkZ + offsets[out][2], oppositeFace(face),
+                  step.directions | 1u << out);
+        }
+    }
+    return true;
+}
+
+#endif // SECTION_VISIBILITY_H
@@ -1,7 +1,16 @@
+#include <cstddef>
 #include "FastNoiseLite.h"
+#include "density_lattice.h"
 
 inline int seed = random() * 10000;
 constexpr unsigned int SCR_WIDTH = 1280;
 constexpr unsigned int SCR_HEIGHT = 768;
 constexpr int renderDistance = 4;
-constexpr int cleanupRadius = renderDistance + 2;
+constexpr int prefetchDistance = 2;     // Chunks ahead of the camera loaded and meshed along its velocity
+constexpr float prefetchSeconds = 2.0f; // How far ahead the velocity is followed, before prefetchDistance caps it
+constexpr int unloadSlack = 1;          // Chunks the player can turn back before anything is unloaded
+constexpr int cleanupRadius = renderDistance + 1 + prefetchDistance + unloadSlack;
+constexpr LatticeStep caveLatticeStep = {4, 8, 4}; // Cave and tunnel noise sampling, {1, 1, 1} for every block
+constexpr std::size_t surfaceCacheTiles = 64; // Regions of heights and biomes kept, 32 KiB each
+constexpr bool caveCulling = true; // Skip sections the camera can't see through open blocks, see findVisibleSections()
+constexpr const char* worldDirectory = "../world"; // Saved chunks, one subdirectory per seed
@@ -7,17 +7,23 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include "gl_render_state_backend.h"
+#include "gl_uniform_backend.h"
+#include "uniform_table.h"
+
 class Shader
 {
 public:
     unsigned int ID;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader(const char* vertexPath, const char* fragmentPath, UniformBackend& uniformBackend = glUniformBackend())
+        : uniforms(uniformBackend)
     {
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
@@ -70,74 +76,92 @@ public:
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
-
+        // resolve every uniform location once, the setters below never ask the driver
+        uniforms.link(ID);
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use() const
     {
-        glUseProgram(ID);
+        renderState().useProgram(ID);
+    }
+    // utility uniform functions, values the program already has are not sent again
+    // ------------------------------------------------------------------------
+    template <typename T>
+    Uniform<T> uniform(std::string_view name) const
+    {
+        return {uniforms.slot(name)};
+    }
+    template <typename T>
+    void set(Uniform<T> uniform, const T &value)
+    {
+        uniforms.set(uniform.slot, value);
+    }
+    UniformStats uniformStats() const
+    {
+        return uniforms.stats();
     }
-    // utility uniform functions
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    void setBool(std::string_view name, bool value)
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        uniforms.set(uniforms.slot(name), (int)value);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setInt(std::string_view name, int value)
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        uniforms.set(uniforms.slot(name), value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    void setFloat(std::string_view name, float value)
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        uniforms.set(uniforms.slot(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string &name, const glm::vec2 &value) const
+    void setVec2(std::string_view name, const glm::vec2 &value)
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        uniforms.set(uniforms.slot(name), value);
     }
-    void setVec2(const std::string &name, float x, float y) const
+    void setVec2(std::string_view name, float x, float y)
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        uniforms.set(uniforms.slot(name), glm::vec2(x, y));
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string &name, const glm::vec3 &value) const
+    void setVec3(std::string_view name, const glm::vec3 &value)
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        uniforms.set(uniforms.slot(name), value);
     }
-    void setVec3(const std::string &name, float x, float y, float z) const
+    void setVec3(std::string_view name, float x, float y, float z)
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        uniforms.set(uniforms.slot(name), glm::vec3(x, y, z));
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string &name, const glm::vec4 &value) const
+    void setVec4(std::string_view name, const glm::vec4 &value)
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        uniforms.set(uniforms.slot(name), value);
     }
-    void setVec4(const std::string &name, float x, float y, float z, float w) const
+    void setVec4(std::string_view name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        uniforms.set(uniforms.slot(name), glm::vec4(x, y, z, w));
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string &name, const glm::mat2 &mat) const
+    void setMat2(std::string_view name, const glm::mat2 &mat)
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        uniforms.set(uniforms.slot(name), mat);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string &name, const glm::mat3 &mat) const
+    void setMat3(std::string_view name, const glm::mat3 &mat)
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        uniforms.set(uniforms.slot(name), mat);
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string &name, const glm::mat4 &mat) const
+    void setMat4(std::string_view name, const glm::mat4 &mat)
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        uniforms.set(uniforms.slot(name), mat);
     }
 
 private:
+    UniformTable uniforms;
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -1,8 +1,9 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 TexCoord;
-in vec2 TexCoord2;
+in vec2 TileCoord;
+flat in vec2 TexOffset;
+flat in vec2 TexOffsetOverlay;
 in vec3 Normal;
 in vec3 FragPos;
 
@@ -20,6 +21,10 @@ void main()
    vec3 diffuse = diff * lightColor;
    float ambientStrength = 0.3;
    vec3 ambient = ambientStrength * lightColor;
+   // Repeat the tile once per block so merged quads keep the block-sized texture
+   vec2 tileUV = vec2(0.0, 0.9375) + fract(TileCoord) * 0.0625;
+   vec2 TexCoord = tileUV + TexOffset * 0.0625;
+   vec2 TexCoord2 = tileUV + TexOffsetOverlay * 0.0625;
    // Sample both textures
    vec4 baseColor = texture(ourTexture, TexCoord);
    vec4 topColor = texture(topTexture, TexCoord2) * tintColor;
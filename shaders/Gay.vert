@@ -2,34 +2,65 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
-// Instanced attributes
-layout (location = 2) in vec2 aTexOffset;
-layout (location = 3) in vec2 aTexOffsetOverlay;
-layout (location = 4) in vec4 model1;
-layout (location = 5) in vec4 model2;
-layout (location = 6) in vec4 model3;
-layout (location = 7) in vec4 model4;
-layout (location = 8) in vec3 aNormal;
-
-out vec2 TexCoord;
+// Instanced attribute, one PackedFace (face_format.h) per face
+layout (location = 2) in uvec2 aFace;
+
+out vec2 TileCoord; // Position on the quad in blocks, the fragment shader wraps it into one atlas tile
+flat out vec2 TexOffset;
+flat out vec2 TexOffsetOverlay;
 out vec3 Normal;
 out vec3 FragPos;
 
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec2 chunkOffset; // World position of the chunk's (0, 0) corner
+
+const vec3 normals[6] = vec3[6](
+    vec3(0.0, 0.0, -1.0),
+    vec3(0.0, 0.0, 1.0),
+    vec3(-1.0, 0.0, 0.0),
+    vec3(1.0, 0.0, 0.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(0.0, -1.0, 0.0)
+);
 
-out vec2 TexCoord2;
+// Atlas tile index to (column, -row), the layout the texture offsets always used
+vec2 atlasOffset(uint tile)
+{
+    return vec2(float(tile & 15u), -float(tile >> 4u));
+}
 
+// Keep in sync with decodeFaceVertex in face_format.h
 void main()
 {
-    mat4 model;
-    model[0] = model1;
-    model[1] = model2;
-    model[2] = model3;
-    model[3] = model4;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    TexCoord = aTexCoord + (aTexOffset * 0.0625);
-    TexCoord2 = aTexCoord + (aTexOffsetOverlay * 0.0625);
-    Normal = aNormal;
-    FragPos = vec3(model * vec4(aPos, 1.0));
+    uint face = (aFace.x >> 15u) & 7u;
+    uint flags = (aFace.x >> 18u) & 3u;
+    vec3 block = vec3(float(aFace.x & 15u), float((aFace.x >> 4u) & 127u), float((aFace.x >> 11u) & 15u));
+    vec2 size = vec2(float((aFace.x >> 20u) & 15u) + 1.0, float((aFace.x >> 24u) & 15u) + 1.0);
+
+    // Stretch the unit quad at z = -0.5 over the merged blocks, then rotate it onto the requested face
+    vec3 corner = vec3((aPos.xy + 0.5) * size - 0.5, aPos.z);
+    vec3 p;
+    if (face == 0u) p = corner;
+    else if (face == 1u) p = vec3(-corner.x, corner.y, -corner.z);
+    else if (face == 2u) p = vec3(corner.z, corner.y, -corner.x);
+    else if (face == 3u) p = vec3(-corner.z, corner.y, corner.x);
+    else if (face == 4u) p = vec3(corner.x, -corner.z, corner.y);
+    else p = vec3(corner.x, corner.z, -corner.y);
+
+    if ((flags & 2u) != 0u) { // Lowered liquid surface
+        if (face == 4u) p.y -= 1.0 / 16.0;
+        else p.y = (p.y - 1.0 / 32.0) * (1.0 - 1.0 / 16.0);
+    }
+    if ((flags & 1u) != 0u) { // Cactus sides are inset by one pixel
+        p -= normals[face] * (1.0 / 16.0);
+    }
+
+    vec3 worldPos = vec3(chunkOffset.x, 0.0, chunkOffset.y) + block + p;
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+    TileCoord = (aTexCoord - vec2(0.0, 0.9375)) * 16.0 * size;
+    TexOffset = atlasOffset(aFace.y & 255u);
+    TexOffsetOverlay = atlasOffset((aFace.y >> 8u) & 255u);
+    Normal = normals[face];
+    FragPos = worldPos;
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Names a value in a Slab without keeping it alive. Once the value is destroyed its slot's generation moves on, so
+// an old handle can never be mistaken for whatever is put in the same slot afterwards.
+struct SlabHandle {
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0; // Never a live generation, so a default handle is always stale
+
+    bool operator==(const SlabHandle& other) const = default;
+};
+
+struct SlabStats {
+    std::size_t live = 0;  // Values created and not destroyed yet
+    std::size_t slots = 0; // Live plus free slots, the slab never gives memory back
+};
+
+// Stable storage for values of one type, in blocks of BlockSize slots that are never moved or freed before the slab
+// is. Destroyed slots are reused first, so a churning set of values keeps landing in the same memory instead of
+// going back and forth to the allocator. create() and destroy() lock, alive() and get() don't.
+template <typename T, std::size_t BlockSize = 64, std::size_t MaxBlocks = 4096>
+class Slab {
+public:
+    Slab() = default;
+
+    Slab(const Slab&) = delete;
+    Slab& operator=(const Slab&) = delete;
+
+    ~Slab() {
+        for (std::atomic<Block*>& block : blocks) {
+            Block* b = block.load(std::memory_order_relaxed);
+            if (!b) break;
+            for (Slot& slot : b->slots) {
+                if (slot.occupied) std::launder(reinterpret_cast<T*>(slot.storage))->~T();
+            }
+            delete b;
+        }
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot* slot;
+        if (freeList) {
+            slot = freeList;
+            freeList = slot->nextFree;
+        } else {
+            if (slotCount == BlockSize * MaxBlocks) throw std::length_error("Slab is full");
+            if (slotCount % BlockSize == 0) {
+                auto* block = new Block();
+                for (std::size_t i = 0; i < BlockSize; ++i) {
+                    block->slots[i].index = static_cast<std::uint32_t>(slotCount + i);
+                }
+                blocks[slotCount / BlockSize].store(block, std::memory_order_release);
+            }
+            slot = &blocks[slotCount / BlockSize].load(std::memory_order_relaxed)->slots[slotCount % BlockSize];
+            slotCount++;
+        }
+        T* value = new (slot->storage) T(std::forward<Args>(args)...);
+        slot->occupied = true;
+        liveCount++;
+        return value;
+    }
+
+    // Ends value's generation, every handle to it is stale from here on
+    void destroy(T* value) {
+        Slot* slot = slotOf(value);
+        value->~T();
+        std::lock_guard<std::mutex> lock(mutex);
+        std::uint32_t next = slot->generation.load(std::memory_order_relaxed) + 1;
+        slot->generation.store(next == 0 ? 1 : next, std::memory_order_release);
+        slot->occupied = false;
+        slot->nextFree = freeList;
+        freeList = slot;
+        liveCount--;
+    }
+
+    // Only for values that came from a Slab<T> and haven't been destroyed
+    static SlabHandle handle(const T* value) {
+        const Slot* slot = slotOf(value);
+        return {slot->index, slot->generation.load(std::memory_order_acquire)};
+    }
+
+    bool alive(SlabHandle handle) const {
+        const Slot* slot = find(handle.index);
+        return slot && slot->generation.load(std::memory_order_acquire) == handle.generation;
+    }
+
+    // Null if the handle is stale. The value may still be destroyed right after, so this is for callers that know
+    // nothing destroys it meanwhile, like the owner of a reference to it.
+    T* get(SlabHandle handle) const {
+        const Slot* slot = find(handle.index);
+        if (!slot || slot->generation.load(std::memory_order_acquire) != handle.generation) return nullptr;
+        return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(slot->storage)));
+    }
+
+    SlabStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {liveCount, slotCount};
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)]; // First, so a value's address is its slot's
+        std::atomic<std::uint32_t> generation{1};
+        std::uint32_t index = 0;
+        bool occupied = false;
+        Slot* nextFree = nullptr;
+    };
+    struct Block {
+        std::array<Slot, BlockSize> slots;
+    };
+
+    std::array<std::atomic<Block*>, MaxBlocks> blocks{};
+    mutable std::mutex mutex;
+    Slot* freeList = nullptr;
+    std::size_t slotCount = 0;
+    std::size_t liveCount = 0;
+
+    static Slot* slotOf(const T* value) {
+        return reinterpret_cast<Slot*>(const_cast<T*>(value));
+    }
+
+    const Slot* find(std::uint32_t index) const {
+        if (index >= BlockSize * MaxBlocks) return nullptr;
+        const Block* block = blocks[index / BlockSize].load(std::memory_order_acquire);
+        return block ? &block->slots[index % BlockSize] : nullptr;
+    }
+};
+
+#endif // SLAB_H
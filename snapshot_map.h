@@ -0,0 +1,129 @@
+#ifndef SNAPSHOT_MAP_H
+#define SNAPSHOT_MAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "slab.h"
+
+struct SnapshotMapStats {
+    std::size_t entries = 0;   // In the current snapshot
+    std::size_t retired = 0;   // Removed, but still held by a reader or an older snapshot
+    std::uint64_t version = 0; // Snapshots published so far
+};
+
+// A map whose readers never lock: snapshot() hands out the current version of the map, which is never modified
+// again, and writers build the next version from a copy and publish it. Values are shared between versions and live
+// until the last snapshot or reference that can reach them is gone, so anything a reader found stays valid for as
+// long as it holds on to it, no matter what was removed meanwhile. The values themselves are not protected, only
+// which keys are in the map. Writes copy the whole map, which suits a few thousand entries changed in batches.
+// Values live in a slab, and handle() names one without keeping it alive. Entries can be any container with the
+// std::map interface for find(), emplace(), erase(key) and iteration over (key, value) pairs.
+template <typename Key, typename Value, typename Entries_ = std::map<Key, std::shared_ptr<Value>>>
+class SnapshotMap {
+public:
+    using Entries = Entries_;
+
+    SnapshotMap() : current(std::make_shared<const Entries>()), values(std::make_shared<Slab<Value>>()) {}
+
+    SnapshotMap(const SnapshotMap&) = delete;
+    SnapshotMap& operator=(const SnapshotMap&) = delete;
+
+    // The map as it is now, unaffected by later writes
+    std::shared_ptr<const Entries> snapshot() const {
+        return current.load(std::memory_order_acquire);
+    }
+
+    // Null if key isn't in the current snapshot
+    std::shared_ptr<Value> find(const Key& key) const {
+        const std::shared_ptr<const Entries> entries = snapshot();
+        auto it = entries->find(key);
+        return it != entries->end() ? it->second : nullptr;
+    }
+
+    // Calls fn(Writer&) on a copy of the current map and publishes the copy afterwards, if fn changed anything.
+    // Writes are serialised, readers keep seeing the previous version until this returns.
+    template <typename Fn>
+    void update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        Writer writer(*this, *current.load(std::memory_order_relaxed));
+        fn(writer);
+        if (writer.changed) {
+            current.store(std::make_shared<const Entries>(std::move(writer.entries)), std::memory_order_release);
+            version.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // The next version of the map while update() builds it
+    class Writer {
+    public:
+        // Adds a value constructed from args unless key is already there, returns the one in the map either way
+        template <typename... Args>
+        std::shared_ptr<Value> tryEmplace(const Key& key, Args&&... args) {
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                return it->second;
+            }
+            changed = true;
+            return entries.emplace(key, map.create(std::forward<Args>(args)...)).first->second;
+        }
+
+        // The removed value stays alive for whoever still holds it
+        bool erase(const Key& key) {
+            const bool erased = entries.erase(key) > 0;
+            changed |= erased;
+            return erased;
+        }
+
+        const Entries& view() const {
+            return entries;
+        }
+
+    private:
+        friend class SnapshotMap;
+        SnapshotMap& map;
+        Entries entries;
+        bool changed = false;
+
+        Writer(SnapshotMap& map, const Entries& entries) : map(map), entries(entries) {}
+    };
+
+    // Stays comparable after value is freed, and never equal to the handle of a value created later
+    static SlabHandle handle(const Value& value) {
+        return Slab<Value>::handle(&value);
+    }
+
+    // False once the value handle names is freed, which can be a while after it left the map
+    bool alive(SlabHandle handle) const {
+        return values->alive(handle);
+    }
+
+    SnapshotMapStats stats() const {
+        SnapshotMapStats result;
+        const std::shared_ptr<const Entries> entries = snapshot(); // Held so none of its values go while counting
+        result.entries = entries->size();
+        result.retired = values->stats().live - result.entries;
+        result.version = version.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    std::atomic<std::shared_ptr<const Entries>> current;
+    std::mutex writeMutex;
+    std::atomic<std::uint64_t> version{0};
+    // Shared with the values' deleters, which can run after the map itself is gone
+    std::shared_ptr<Slab<Value>> values;
+
+    template <typename... Args>
+    std::shared_ptr<Value> create(Args&&... args) {
+        return std::shared_ptr<Value>(values->create(std::forward<Args>(args)...), [values = values](Value* value) {
+            values->destroy(value);
+        });
+    }
+};
+
+#endif // SNAPSHOT_MAP_H
@@ -0,0 +1,189 @@
+#ifndef SURFACE_CACHE_H
+#define SURFACE_CACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "FastNoiseLite.h"
+
+// The 2D part of world generation for one column: terrain height and biome
+struct ColumnSurface {
+    int height;
+    bool forest;
+    bool desert;
+};
+
+constexpr int SURFACE_TILE_SIZE = 64; // Columns along x and z, a whole number of chunks
+
+// The columns of one SURFACE_TILE_SIZE x SURFACE_TILE_SIZE region, x fastest
+struct SurfaceTile {
+    ColumnSurface columns[SURFACE_TILE_SIZE * SURFACE_TILE_SIZE];
+
+    const ColumnSurface& at(int localX, int localZ) const {
+        return columns[localZ * SURFACE_TILE_SIZE + localX];
+    }
+};
+
+struct SurfaceCacheStats {
+    std::size_t tiles = 0;
+    std::size_t capacity = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+
+    double hitRate() const {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+};
+
+// Heights and biomes by region, shared by every chunk, decoration pass and height query in the region instead of
+// each of them running the 2D noise for its own columns. Thread safe. At most capacity tiles are kept, the least
+// recently used one goes first. Tiles are computed outside the lock; a thread asking for a tile another thread is
+// still computing waits for that one instead of computing it again.
+class SurfaceCache {
+public:
+    // maxHeight is the world height, surfaces are clamped below it
+    SurfaceCache(std::size_t capacity, int maxHeight) : capacity(std::max<std::size_t>(capacity, 1)), maxHeight(maxHeight) {}
+
+    std::shared_ptr<const SurfaceTile> tile(int seed, int regionX, int regionZ) {
+        const Key key(seed, regionX, regionZ);
+        std::promise<std::shared_ptr<const SurfaceTile>> promise;
+        std::shared_future<std::shared_ptr<const SurfaceTile>> future;
+        bool computeHere = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                hits++;
+                recency.splice(recency.begin(), recency, it->second.recency);
+                future = it->second.tile;
+            } else {
+                misses++;
+                computeHere = true;
+                future = promise.get_future().share();
+                recency.push_front(key);
+                entries.emplace(key, Entry{future, recency.begin()});
+                evict();
+            }
+        }
+        if (computeHere) {
+            promise.set_value(compute(seed, regionX, regionZ));
+        }
+        return future.get();
+    }
+
+    ColumnSurface surfaceAt(int seed, int worldX, int worldZ) {
+        return tile(seed, regionOf(worldX), regionOf(worldZ))->at(localOf(worldX), localOf(worldZ));
+    }
+
+    // Copies the columns of a sizeX x sizeZ chunk at block (worldX, worldZ) into out, index x * sizeZ + z. The chunk
+    // has to lie inside one tile, which it does as long as the tile size is a multiple of the chunk size.
+    void chunkSurface(int seed, int worldX, int worldZ, int sizeX, int sizeZ, ColumnSurface* out) {
+        const std::shared_ptr<const SurfaceTile> region = tile(seed, regionOf(worldX), regionOf(worldZ));
+        const int localX = localOf(worldX);
+        const int localZ = localOf(worldZ);
+        for (int x = 0; x < sizeX; ++x) {
+            for (int z = 0; z < sizeZ; ++z) {
+                out[x * sizeZ + z] = region->at(localX + x, localZ + z);
+            }
+        }
+    }
+
+    SurfaceCacheStats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        SurfaceCacheStats result;
+        result.tiles = entries.size();
+        result.capacity = capacity;
+        result.hits = hits;
+        result.misses = misses;
+        result.evictions = evictions;
+        return result;
+    }
+
+    static int regionOf(int world) {
+        return world >= 0 ? world / SURFACE_TILE_SIZE : (world + 1) / SURFACE_TILE_SIZE - 1;
+    }
+
+    static int localOf(int world) {
+        return world - regionOf(world) * SURFACE_TILE_SIZE;
+    }
+
+private:
+    using Key = std::tuple<int, int, int>; // Seed, region x, region z
+
+    struct Entry {
+        std::shared_future<std::shared_ptr<const SurfaceTile>> tile;
+        std::list<Key>::iterator recency;
+    };
+
+    const std::size_t capacity;
+    const int maxHeight;
+    std::mutex mutex;
+    std::map<Key, Entry> entries;
+    std::list<Key> recency; // Most recently used first
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+
+    // Called with the mutex held. Threads already holding an evicted tile's future still get the tile.
+    void evict() {
+        while (entries.size() > capacity) {
+            entries.erase(recency.back());
+            recency.pop_back();
+            evictions++;
+        }
+    }
+
+    std::shared_ptr<const SurfaceTile> compute(int seed, int regionX, int regionZ) const {
+        FastNoiseLite baseNoise, detailNoise, biomeNoise;
+
+        // Set seeds for reproducibility
+        baseNoise.SetSeed(seed);
+        detailNoise.SetSeed(seed);
+        biomeNoise.SetSeed(seed);
+
+        // Configure noise types and frequencies
+        baseNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+        baseNoise.SetFrequency(0.01f); // Large-scale terrain
+
+        detailNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+        detailNoise.SetFrequency(0.05f); // Small-scale features
+
+        biomeNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+        biomeNoise.SetFrequency(0.005f); // Biome distribution
+
+        constexpr int columns = SURFACE_TILE_SIZE * SURFACE_TILE_SIZE;
+        const double worldX0 = regionX * SURFACE_TILE_SIZE * 1.0;
+        const double worldZ0 = regionZ * SURFACE_TILE_SIZE * 1.0;
+        std::vector<float> biomeValues(columns), baseValues(columns), detailValues(columns);
+        biomeNoise.GenUniformGrid2D(biomeValues.data(), worldX0, worldZ0, SURFACE_TILE_SIZE, SURFACE_TILE_SIZE);
+        baseNoise.GenUniformGrid2D(baseValues.data(), worldX0, worldZ0, SURFACE_TILE_SIZE, SURFACE_TILE_SIZE);
+        detailNoise.GenUniformGrid2D(detailValues.data(), worldX0, worldZ0, SURFACE_TILE_SIZE, SURFACE_TILE_SIZE);
+
+        auto tile = std::make_shared<SurfaceTile>();
+        for (int column = 0; column < columns; ++column) {
+            // Biome noise determines the biome type
+            double biomeValue = biomeValues[column];
+
+            // Base terrain height
+            double baseHeight = baseValues[column] * 10 + 60;
+
+            // Add detail to terrain
+            double detailHeight = detailValues[column] * 5;
+
+            // Combine base and detail noise for final terrain height, clamped to the world's maximum height
+            int blockHeight = static_cast<int>(baseHeight + detailHeight);
+            tile->columns[column] = {std::min(blockHeight, maxHeight - 1), biomeValue > 0.2, biomeValue < -0.2};
+        }
+        return tile;
+    }
+};
+
+#endif // SURFACE_CACHE_H
@@ -0,0 +1,50 @@
+#include <cmath>
+#include "camera_path.h"
+#include "test.h"
+
+static bool near(glm::vec3 a, glm::vec3 b) {
+    return glm::length(a - b) < 1e-5f;
+}
+
+static void interpolatesBetweenKeyframes() {
+    CameraPath path;
+    path.add(0.0f, glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    path.add(2.0f, glm::vec3(4.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    CHECK(path.size() == 2);
+    CHECK(path.duration() == 2.0f);
+
+    const CameraKeyframe middle = path.sample(1.0f);
+    CHECK(middle.seconds == 1.0f);
+    CHECK(near(middle.position, glm::vec3(2.0f, 0.0f, 0.0f)));
+    CHECK(near(middle.front, glm::normalize(glm::vec3(1.0f, 0.0f, 1.0f))));
+}
+
+static void holdsTheEndsOutsideThePath() {
+    CameraPath path;
+    path.add(1.0f, glm::vec3(1.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    path.add(3.0f, glm::vec3(3.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    CHECK(near(path.sample(-5.0f).position, glm::vec3(1.0f)));
+    CHECK(near(path.sample(0.5f).position, glm::vec3(1.0f)));
+    CHECK(near(path.sample(10.0f).position, glm::vec3(3.0f)));
+}
+
+// A half turn between two keyframes passes through a zero vector halfway
+static void turningAroundStaysFinite() {
+    CameraPath path;
+    path.add(0.0f, glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    path.add(1.0f, glm::vec3(0.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
+    for (float seconds : {0.25f, 0.5f, 0.75f}) {
+        const glm::vec3 front = path.sample(seconds).front;
+        CHECK(std::isfinite(front.x) && std::isfinite(front.y) && std::isfinite(front.z));
+        CHECK(std::abs(glm::length(front) - 1.0f) < 1e-5f);
+    }
+    CHECK(near(path.sample(0.5f).front, glm::vec3(1.0f, 0.0f, 0.0f)));
+    CHECK(near(path.sample(0.75f).front, glm::vec3(-1.0f, 0.0f, 0.0f)));
+}
+
+int main() {
+    interpolatesBetweenKeyframes();
+    holdsTheEndsOutsideThePath();
+    turningAroundStaysFinite();
+    return testResult();
+}
@@ -0,0 +1,152 @@
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "chunk_index.h"
+#include "slab.h"
+#include "test.h"
+
+// Positions whose packed keys share a home slot in a table of 16, the size ChunkIndex starts at
+static std::vector<ChunkPosition> collidingPositions(std::size_t count) {
+    std::vector<ChunkPosition> positions;
+    std::uint64_t wanted = 0;
+    for (int x = -50; x < 50 && positions.size() < count; ++x) {
+        for (int z = -50; z < 50 && positions.size() < count; ++z) {
+            const std::uint64_t home = (packChunkPosition(ChunkPosition(x, z)) * 0x9E3779B97F4A7C15ull) >> 60;
+            if (positions.empty()) wanted = home;
+            if (home == wanted) positions.emplace_back(x, z);
+        }
+    }
+    return positions;
+}
+
+static void packsNegativePositions() {
+    CHECK(packChunkPosition(ChunkPosition(0, 0)) == 0);
+    CHECK(packChunkPosition(ChunkPosition(-1, 0)) == 0xFFFFFFFF00000000ull);
+    CHECK(packChunkPosition(ChunkPosition(0, -1)) == 0x00000000FFFFFFFFull);
+    CHECK(packChunkPosition(ChunkPosition(-1, -1)) == ~0ull);
+    CHECK(packChunkPosition(ChunkPosition(1, -2)) != packChunkPosition(ChunkPosition(-2, 1)));
+
+    ChunkIndex<int> index;
+    int value = 0;
+    for (int x = -3; x <= 3; ++x) {
+        for (int z = -3; z <= 3; ++z) {
+            CHECK(index.emplace(ChunkPosition(x, z), value++).second);
+        }
+    }
+    CHECK(index.size() == 49);
+    value = 0;
+    for (int x = -3; x <= 3; ++x) {
+        for (int z = -3; z <= 3; ++z) {
+            CHECK(index.contains(ChunkPosition(x, z)));
+            CHECK(index.at(ChunkPosition(x, z)) == value++);
+        }
+    }
+    CHECK(!index.contains(ChunkPosition(-4, 0)));
+    CHECK(!index.contains(ChunkPosition(0, -4)));
+    bool thrown = false;
+    try {
+        index.at(ChunkPosition(-4, -4));
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+static void erasesBetweenCollidingKeys() {
+    const std::vector<ChunkPosition> colliding = collidingPositions(5);
+    CHECK(colliding.size() == 5);
+
+    ChunkIndex<int> index;
+    for (std::size_t i = 0; i < colliding.size(); ++i) {
+        CHECK(index.emplace(colliding[i], static_cast<int>(i)).second);
+        CHECK(!index.emplace(colliding[i], -1).second);
+    }
+
+    // Erasing the head of the run shifts the rest back, erasing from the middle and the end leaves no gap either
+    CHECK(index.erase(colliding[0]) == 1);
+    CHECK(index.erase(colliding[2]) == 1);
+    CHECK(index.erase(colliding[4]) == 1);
+    CHECK(index.erase(colliding[4]) == 0);
+    CHECK(index.size() == 2);
+    CHECK(!index.contains(colliding[0]));
+    CHECK(index.at(colliding[1]) == 1);
+    CHECK(!index.contains(colliding[2]));
+    CHECK(index.at(colliding[3]) == 3);
+
+    int seen = 0;
+    for (const auto& [position, value] : index) {
+        CHECK(position == colliding[value]);
+        seen++;
+    }
+    CHECK(seen == 2);
+
+    CHECK(index.emplace(colliding[2], 20).second);
+    CHECK(index.emplace(colliding[0], 10).second);
+    CHECK(index.at(colliding[0]) == 10);
+    CHECK(index.at(colliding[1]) == 1);
+    CHECK(index.at(colliding[2]) == 20);
+    CHECK(index.at(colliding[3]) == 3);
+}
+
+// Random inserts and erases over a small area, growing through several rehashes, against std::map
+static void matchesStdMap() {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> coordinate(-20, 20);
+    ChunkIndex<int> index;
+    std::map<ChunkPosition, int> reference;
+    for (int i = 0; i < 20000; ++i) {
+        const ChunkPosition position(coordinate(random), coordinate(random));
+        if (random() % 3 == 0) {
+            CHECK(index.erase(position) == reference.erase(position));
+        } else {
+            CHECK(index.emplace(position, i).second == reference.emplace(position, i).second);
+        }
+    }
+    CHECK(index.size() == reference.size());
+    for (const auto& [position, value] : reference) {
+        auto it = index.find(position);
+        CHECK(it != index.end() && it->second == value);
+    }
+    std::size_t iterated = 0;
+    for (const auto& entry : index) {
+        CHECK(reference.count(entry.first) == 1);
+        iterated++;
+    }
+    CHECK(iterated == reference.size());
+}
+
+static void staleHandlesDontResolve() {
+    Slab<int> slab;
+    CHECK(!slab.alive(SlabHandle()));
+
+    int* first = slab.create(1);
+    const SlabHandle firstHandle = Slab<int>::handle(first);
+    CHECK(slab.alive(firstHandle));
+    CHECK(slab.get(firstHandle) == first);
+
+    slab.destroy(first);
+    CHECK(!slab.alive(firstHandle));
+    CHECK(slab.get(firstHandle) == nullptr);
+
+    // The freed slot is reused first, under a new generation
+    int* second = slab.create(2);
+    const SlabHandle secondHandle = Slab<int>::handle(second);
+    CHECK(second == first);
+    CHECK(secondHandle.index == firstHandle.index);
+    CHECK(!(secondHandle == firstHandle));
+    CHECK(!slab.alive(firstHandle));
+    CHECK(slab.get(firstHandle) == nullptr);
+    CHECK(slab.get(secondHandle) == second && *second == 2);
+    CHECK(slab.stats().live == 1);
+    CHECK(slab.stats().slots == 1);
+    slab.destroy(second);
+}
+
+int main() {
+    packsNegativePositions();
+    erasesBetweenCollidingKeys();
+    matchesStdMap();
+    staleHandlesDontResolve();
+    return testResult();
+}
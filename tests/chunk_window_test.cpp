@@ -0,0 +1,164 @@
+#include <set>
+#include <vector>
+#include "chunk_window.h"
+#include "test.h"
+
+constexpr int RADIUS = 2;
+
+static int valueFor(int x, int z) {
+    return x * 1000 + z;
+}
+
+// Every cell around the window's centre filled with valueFor() its position
+static void fill(ChunkWindow<int>& window) {
+    const ChunkPosition centre = window.center();
+    for (int x = centre.first - RADIUS; x <= centre.first + RADIUS; ++x) {
+        for (int z = centre.second - RADIUS; z <= centre.second + RADIUS; ++z) {
+            window.emplace(x, z) = valueFor(x, z);
+        }
+    }
+}
+
+static bool holdsItsValues(ChunkWindow<int>& window) {
+    const ChunkPosition centre = window.center();
+    for (int x = centre.first - RADIUS; x <= centre.first + RADIUS; ++x) {
+        for (int z = centre.second - RADIUS; z <= centre.second + RADIUS; ++z) {
+            const int* value = window.find(x, z);
+            if (value && *value != valueFor(x, z)) return false;
+        }
+    }
+    return true;
+}
+
+struct Evictions {
+    std::set<ChunkPosition> positions;
+    int withValues = 0;
+    bool valuesMatch = true;
+
+    auto recorder() {
+        return [this](ChunkPosition position, int* value) {
+            positions.insert(position);
+            if (value) {
+                withValues++;
+                valuesMatch = valuesMatch && *value == valueFor(position.first, position.second);
+            }
+        };
+    }
+};
+
+static void crossingABorderEvictsOneColumn() {
+    ChunkWindow<int> window(RADIUS);
+    fill(window);
+    CHECK(window.size() == 25);
+
+    Evictions evictions;
+    window.recenter(1, 0, evictions.recorder());
+    std::set<ChunkPosition> column;
+    for (int z = -RADIUS; z <= RADIUS; ++z) column.emplace(-RADIUS, z);
+    CHECK(evictions.positions == column);
+    CHECK(evictions.withValues == 5);
+    CHECK(evictions.valuesMatch);
+    CHECK(window.size() == 20);
+    CHECK(holdsItsValues(window));
+    // The column that scrolled in reuses the evicted cells, empty
+    for (int z = -RADIUS; z <= RADIUS; ++z) {
+        CHECK(window.find(3, z) == nullptr);
+        CHECK(window.find(-RADIUS, z) == nullptr);
+    }
+
+    // Diagonally, a column and a row go, sharing their corner
+    fill(window);
+    Evictions diagonal;
+    window.recenter(2, 1, diagonal.recorder());
+    CHECK(diagonal.positions.size() == 9);
+    CHECK(diagonal.withValues == 9);
+    CHECK(diagonal.valuesMatch);
+    CHECK(window.size() == 16);
+    CHECK(holdsItsValues(window));
+
+    // Staying put evicts nothing
+    Evictions none;
+    window.recenter(2, 1, none.recorder());
+    CHECK(none.positions.empty());
+    CHECK(window.size() == 16);
+}
+
+static void jumpingFurtherThanTheWindowEvictsEverything() {
+    ChunkWindow<int> window(RADIUS);
+    fill(window);
+    window.erase(0, 0);
+
+    Evictions evictions;
+    window.recenter(100, -40, evictions.recorder());
+    CHECK(evictions.positions.size() == 25);
+    CHECK(evictions.positions.count(ChunkPosition(0, 0)) == 1); // Empty cells are reported too, without a value
+    CHECK(evictions.withValues == 24);
+    CHECK(evictions.valuesMatch);
+    CHECK(window.size() == 0);
+    CHECK(window.contains(100, -40) && !window.contains(0, 0));
+    for (int x = 100 - RADIUS; x <= 100 + RADIUS; ++x) {
+        for (int z = -40 - RADIUS; z <= -40 + RADIUS; ++z) {
+            CHECK(window.find(x, z) == nullptr);
+        }
+    }
+}
+
+static void wrapsNegativeCoordinates() {
+    ChunkWindow<int> window(RADIUS);
+    Evictions evictions;
+    window.recenter(-7, -12, evictions.recorder());
+    fill(window);
+    CHECK(window.size() == 25);
+    CHECK(holdsItsValues(window));
+    CHECK(window.find(-7 + RADIUS + 1, -12) == nullptr);
+
+    // Scrolling across zero keeps every cell that stays apart from the ones that come in
+    for (int step = 1; step <= 12; ++step) {
+        Evictions moved;
+        window.recenter(-7 + step, -12 + step, moved.recorder());
+        CHECK(moved.valuesMatch);
+        CHECK(holdsItsValues(window));
+        fill(window);
+        CHECK(window.size() == 25);
+    }
+    CHECK(window.center() == ChunkPosition(5, 0));
+    CHECK(*window.find(3, -2) == valueFor(3, -2));
+}
+
+static void visitsNearestFirst() {
+    ChunkWindow<int> window(RADIUS);
+    window.recenter(-3, 4, [](ChunkPosition, int*) {});
+    fill(window);
+
+    std::vector<ChunkPosition> order;
+    window.forEachNearestFirst([&](ChunkPosition position, int& value) {
+        CHECK(value == valueFor(position.first, position.second));
+        order.push_back(position);
+    });
+    CHECK(order.size() == 25);
+    CHECK(order.front() == ChunkPosition(-3, 4));
+    int previous = 0;
+    for (ChunkPosition position : order) {
+        const int dx = position.first + 3;
+        const int dz = position.second - 4;
+        CHECK(dx * dx + dz * dz >= previous);
+        previous = dx * dx + dz * dz;
+    }
+
+    // Empty cells are skipped
+    window.erase(-3, 4);
+    order.clear();
+    window.forEachNearestFirst([&](ChunkPosition position, int&) {
+        order.push_back(position);
+    });
+    CHECK(order.size() == 24);
+    CHECK(order.front() != ChunkPosition(-3, 4));
+}
+
+int main() {
+    crossingABorderEvictsOneColumn();
+    jumpingFurtherThanTheWindowEvictsEverything();
+    wrapsNegativeCoordinates();
+    visitsNearestFirst();
+    return testResult();
+}
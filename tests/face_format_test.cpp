@@ -0,0 +1,80 @@
+#include <cmath>
+#include "face_format.h"
+#include "test.h"
+
+// Every field at both ends of its range, in every combination with the others, comes back out unchanged
+static void roundTripsEveryField() {
+    for (std::uint32_t face = FACE_NEG_Z; face <= FACE_NEG_Y; ++face) {
+        for (std::uint32_t flags = 0; flags < 4; ++flags) {
+            for (int x : {0, 15}) {
+                for (int y : {0, 64, 127}) {
+                    for (int z : {0, 15}) {
+                        for (int size : {1, 2, MAX_QUAD_SIZE}) {
+                            for (int tile : {0, 1, 255}) {
+                                const auto overlay = static_cast<std::uint8_t>(255 - tile);
+                                const DecodedFace f = decodeFace(encodeFace(x, y, z, face, flags, static_cast<std::uint8_t>(tile), overlay, size,
+                                                                            MAX_QUAD_SIZE + 1 - size));
+                                CHECK(f.x == x);
+                                CHECK(f.y == y);
+                                CHECK(f.z == z);
+                                CHECK(f.face == face);
+                                CHECK(f.flags == flags);
+                                CHECK(f.tile == tile);
+                                CHECK(f.overlayTile == overlay);
+                                CHECK(f.width == size);
+                                CHECK(f.height == MAX_QUAD_SIZE + 1 - size);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Every field at its maximum fills exactly the bits the layout gives it, so no field spills into the next
+static void fieldsFillTheirBits() {
+    const PackedFace packed = encodeFace(15, 127, 15, FACE_NEG_Y, 3, 255, 255, MAX_QUAD_SIZE, MAX_QUAD_SIZE);
+    CHECK(packed.position == 0x0FFFFFFFu - (2u << 15)); // face is 5 = 0b101 in its 3 bits
+    CHECK(packed.texture == 0xFFFFu);
+    CHECK(encodeFace(0, 0, 0, FACE_NEG_Z, 0, 0, 0).position == 0);
+}
+
+// The corners of the unit quad land on the side of the block the face points to, for every direction
+static void verticesLieOnTheirFace() {
+    const glm::vec2 chunkOffset(32.0f, -16.0f);
+    const glm::vec3 corners[4] = {{-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}};
+    for (std::uint32_t face = FACE_NEG_Z; face <= FACE_NEG_Y; ++face) {
+        const glm::vec3 block(chunkOffset.x + 3, 70, chunkOffset.y + 9);
+        const glm::vec3 normal = FACE_NORMALS[face];
+        for (const glm::vec3& corner : corners) {
+            const glm::vec3 p = decodeFaceVertex(encodeFace(3, 70, 9, face, 0, 0, 0), chunkOffset, corner);
+            const glm::vec3 offset = p - block;
+            CHECK(std::abs(glm::dot(offset, normal) - 0.5f) < 1e-5f);
+            CHECK(std::abs(std::abs(offset.x) - 0.5f) < 1e-5f);
+            CHECK(std::abs(std::abs(offset.y) - 0.5f) < 1e-5f);
+            CHECK(std::abs(std::abs(offset.z) - 0.5f) < 1e-5f);
+        }
+    }
+}
+
+// A greedy quad of the largest size spans MAX_QUAD_SIZE blocks along both of its axes
+static void largestQuadSpansItsBlocks() {
+    for (std::uint32_t face = FACE_NEG_Z; face <= FACE_NEG_Y; ++face) {
+        const PackedFace packed = encodeFace(0, 0, 0, face, 0, 0, 0, MAX_QUAD_SIZE, MAX_QUAD_SIZE);
+        const glm::vec3 low = decodeFaceVertex(packed, glm::vec2(0.0f), glm::vec3(-0.5f, -0.5f, -0.5f));
+        const glm::vec3 high = decodeFaceVertex(packed, glm::vec2(0.0f), glm::vec3(0.5f, 0.5f, -0.5f));
+        const glm::vec3 extent = glm::abs(high - low);
+        const glm::vec3 normal = glm::abs(FACE_NORMALS[face]);
+        CHECK(std::abs(glm::dot(extent, normal)) < 1e-5f);
+        CHECK(std::abs(extent.x + extent.y + extent.z - 2.0f * MAX_QUAD_SIZE) < 1e-4f);
+    }
+}
+
+int main() {
+    roundTripsEveryField();
+    fieldsFillTheirBits();
+    verticesLieOnTheirFace();
+    largestQuadSpansItsBlocks();
+    return testResult();
+}
@@ -0,0 +1,132 @@
+#include <cmath>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+#include "frustum_culling.h"
+#include "test.h"
+
+static bool near(glm::vec4 a, glm::vec4 b) {
+    return glm::length(a - b) < 1e-3f;
+}
+
+// A 90 degree square frustum at the origin looking down -z, so its side planes are the diagonals x = +-z, y = +-z
+static Frustum originFrustum() {
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return Frustum::fromMatrix(projection * view);
+}
+
+static std::vector<std::uint32_t> cullScalar(const Frustum& frustum, const AabbBatch& boxes) {
+    std::vector<std::uint32_t> visible;
+    cullAabbsScalar(frustum, boxes, visible);
+    return visible;
+}
+
+static std::vector<std::uint32_t> cull(const Frustum& frustum, const AabbBatch& boxes) {
+    std::vector<std::uint32_t> visible;
+    cullAabbs(frustum, boxes, visible);
+    return visible;
+}
+
+static void extractsPlanes() {
+    const Frustum frustum = originFrustum();
+    const float diagonal = 1.0f / std::sqrt(2.0f);
+    CHECK(near(frustum.planes[0], glm::vec4(diagonal, 0.0f, -diagonal, 0.0f)));  // Left
+    CHECK(near(frustum.planes[1], glm::vec4(-diagonal, 0.0f, -diagonal, 0.0f))); // Right
+    CHECK(near(frustum.planes[2], glm::vec4(0.0f, diagonal, -diagonal, 0.0f)));  // Bottom
+    CHECK(near(frustum.planes[3], glm::vec4(0.0f, -diagonal, -diagonal, 0.0f))); // Top
+    CHECK(near(frustum.planes[4], glm::vec4(0.0f, 0.0f, -1.0f, -0.1f)));         // Near
+    CHECK(near(frustum.planes[5], glm::vec4(0.0f, 0.0f, 1.0f, 100.0f)));         // Far
+
+    // The planes are in world space, moving the camera moves them
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(10.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Frustum moved = Frustum::fromMatrix(projection * view);
+    CHECK(near(moved.planes[0], glm::vec4(diagonal, 0.0f, -diagonal, -10.0f * diagonal)));
+    CHECK(near(moved.planes[5], glm::vec4(0.0f, 0.0f, 1.0f, 100.0f)));
+}
+
+static void classifiesBoxes() {
+    const Frustum frustum = originFrustum();
+
+    // Inside
+    CHECK(frustum.intersects(glm::vec3(-1.0f, -1.0f, -11.0f), glm::vec3(1.0f, 1.0f, -9.0f)));
+    // Behind the camera, past the far plane, and off to the left
+    CHECK(!frustum.intersects(glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 3.0f)));
+    CHECK(!frustum.intersects(glm::vec3(-1.0f, -1.0f, -103.0f), glm::vec3(1.0f, 1.0f, -101.0f)));
+    CHECK(!frustum.intersects(glm::vec3(-30.0f, -1.0f, -11.0f), glm::vec3(-20.0f, 1.0f, -9.0f)));
+    // Straddling the near plane, the left plane and the whole frustum
+    CHECK(frustum.intersects(glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f)));
+    CHECK(frustum.intersects(glm::vec3(-15.0f, -1.0f, -11.0f), glm::vec3(-9.0f, 1.0f, -9.0f)));
+    CHECK(frustum.intersects(glm::vec3(-1000.0f), glm::vec3(1000.0f)));
+
+    AabbBatch boxes;
+    boxes.add(glm::vec3(-1.0f, -1.0f, -11.0f), glm::vec3(1.0f, 1.0f, -9.0f));
+    boxes.add(glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 3.0f));
+    boxes.add(glm::vec3(-15.0f, -1.0f, -11.0f), glm::vec3(-9.0f, 1.0f, -9.0f));
+    CHECK(cull(frustum, boxes) == std::vector<std::uint32_t>({0, 2}));
+    CHECK(cullScalar(frustum, boxes) == std::vector<std::uint32_t>({0, 2}));
+}
+
+static void neverReportsPadding() {
+    const Frustum frustum = originFrustum();
+
+    // Boxes that contain the whole frustum are visible for every plane, the padding after them must still not be
+    AabbBatch boxes;
+    for (std::size_t count = 1; count <= 2 * AabbBatch::LANES + 1; ++count) {
+        boxes.add(glm::vec3(-1000.0f), glm::vec3(1000.0f));
+        CHECK(boxes.minX.size() % AabbBatch::LANES == 0);
+        CHECK(cull(frustum, boxes).size() == count);
+        CHECK(cullScalar(frustum, boxes).size() == count);
+    }
+
+    // Cleared batches refill their padding
+    boxes.clear();
+    boxes.add(glm::vec3(-1000.0f), glm::vec3(1000.0f));
+    CHECK(cull(frustum, boxes) == std::vector<std::uint32_t>({0}));
+
+    AabbBatch empty;
+    CHECK(cull(frustum, empty).empty());
+}
+
+static void avxMatchesScalar() {
+#if FRUSTUM_CULLING_AVX
+    if (!__builtin_cpu_supports("avx")) {
+        return;
+    }
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+    std::uniform_real_distribution<float> extent(0.0f, 20.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    const glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 120.0f);
+
+    for (int batch = 0; batch < 50; ++batch) {
+        const glm::vec3 eye(position(random) / 10.0f, position(random) / 10.0f, position(random) / 10.0f);
+        const float yaw = angle(random);
+        const float pitch = (angle(random) - 3.1415927f) / 4.0f;
+        const glm::vec3 front(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+        const Frustum frustum = Frustum::fromMatrix(projection * glm::lookAt(eye, eye + front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        AabbBatch boxes;
+        const int count = 1 + batch * 7; // Covers full and partial blocks of lanes
+        for (int i = 0; i < count; ++i) {
+            const glm::vec3 min(position(random), position(random), position(random));
+            boxes.add(min, min + glm::vec3(extent(random), extent(random), extent(random)));
+        }
+
+        std::vector<std::uint32_t> avx;
+        cullAabbsAVX(frustum, boxes, avx);
+        const std::vector<std::uint32_t> scalar = cullScalar(frustum, boxes);
+        CHECK(avx == scalar);
+        CHECK(cull(frustum, boxes) == scalar);
+    }
+#endif
+}
+
+int main() {
+    extractsPlanes();
+    classifiesBoxes();
+    neverReportsPadding();
+    avxMatchesScalar();
+    return testResult();
+}
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "job_system.h"
+#include "test.h"
+
+static void submitReturnsResultsAndExceptions() {
+    JobSystem jobs(2);
+    std::future<int> answer = jobs.submit([] { return 6 * 7; });
+    std::future<void> failure = jobs.submit([] { throw std::runtime_error("job failed"); });
+    CHECK(answer.get() == 42);
+    bool thrown = false;
+    try {
+        failure.get();
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+// With the only worker busy, whatever piles up runs highest priority first, newest first within a priority
+static void runsHigherPrioritiesFirst() {
+    JobSystem jobs(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> blocking;
+    jobs.dispatch([released, &blocking] {
+        blocking.set_value();
+        released.wait();
+    });
+    blocking.get_future().wait(); // The worker took the blocking job, everything below waits in its deques
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int id) {
+        return [&, id] {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(id);
+        };
+    };
+    std::future<void> last = jobs.submit([] {}, JobPriority::Low); // The oldest Low job, so it runs last
+    jobs.dispatch(record(1), JobPriority::Low);
+    jobs.dispatch(record(2), JobPriority::Normal);
+    jobs.dispatch(record(3), JobPriority::High);
+    jobs.dispatch(record(4), JobPriority::Low);
+    release.set_value();
+    last.wait();
+    CHECK(order == std::vector<int>({3, 2, 4, 1}));
+}
+
+// Jobs dispatched by a running job stay on its worker. While that worker is blocked, the other one steals them all.
+static void idleWorkersSteal() {
+    JobSystem jobs(2);
+    constexpr int childCount = 64;
+    std::atomic<int> done{0};
+    std::promise<void> allDone;
+    std::future<void> parent = jobs.submit([&] {
+        for (int i = 0; i < childCount; ++i) {
+            jobs.dispatch([&] {
+                if (++done == childCount) allDone.set_value();
+            });
+        }
+        allDone.get_future().wait(); // Blocks this worker until the other one ran every child
+    });
+    parent.wait();
+    CHECK(done == childCount);
+    const JobSystemStats stats = jobs.stats();
+    CHECK(stats.steals >= static_cast<std::uint64_t>(childCount)); // The parent may have been stolen as well
+    CHECK(stats.executed >= static_cast<std::uint64_t>(childCount));
+    CHECK(stats.workers == 2);
+}
+
+int main() {
+    submitReturnsResultsAndExceptions();
+    runsHigherPrioritiesFirst();
+    idleWorkersSteal();
+    return testResult();
+}
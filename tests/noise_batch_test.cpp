@@ -0,0 +1,106 @@
+#include <cstring>
+#include <vector>
+#include "FastNoiseLite.h"
+#include "test.h"
+
+// Batched output has to match GetNoise bit for bit, whichever path the CPU takes
+static bool sameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static FastNoiseLite noiseOf(FastNoiseLite::NoiseType type, float frequency, int seed) {
+    FastNoiseLite noise(seed);
+    noise.SetNoiseType(type);
+    noise.SetFrequency(frequency);
+    return noise;
+}
+
+// Sizes that aren't a multiple of the vector width leave a scalar tail, the start crosses zero
+static void gridsMatchGetNoise(const FastNoiseLite& noise) {
+    const int xSize = 21, ySize = 13, zSize = 5;
+    const double xStart = -37.0, yStart = -5.5, zStart = 3.0;
+    std::vector<float> grid(xSize * ySize * zSize);
+
+    noise.GenUniformGrid2D(grid.data(), xStart, yStart, xSize, ySize, 1.0, 0.75);
+    std::size_t mismatches = 0;
+    for (int iy = 0; iy < ySize; ++iy) {
+        for (int ix = 0; ix < xSize; ++ix) {
+            mismatches += !sameBits(grid[iy * xSize + ix], noise.GetNoise(xStart + ix * 1.0, yStart + iy * 0.75));
+        }
+    }
+    CHECK(mismatches == 0);
+
+    noise.GenUniformGrid3D(grid.data(), xStart, yStart, zStart, xSize, ySize, zSize, 1.0, 0.75, 4.0);
+    mismatches = 0;
+    for (int iz = 0; iz < zSize; ++iz) {
+        for (int iy = 0; iy < ySize; ++iy) {
+            for (int ix = 0; ix < xSize; ++ix) {
+                mismatches += !sameBits(grid[(iz * ySize + iy) * xSize + ix],
+                                        noise.GetNoise(xStart + ix * 1.0, yStart + iy * 0.75, zStart + iz * 4.0));
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+static void positionsMatchGetNoise(const FastNoiseLite& noise) {
+    const int count = 203;
+    std::vector<float> x(count), y(count), z(count), out(count);
+    for (int i = 0; i < count; ++i) {
+        x[i] = -500.0f + 4.93f * static_cast<float>(i);
+        y[i] = 17.25f - 0.61f * static_cast<float>(i);
+        z[i] = static_cast<float>((i * 37) % 101) - 50.5f;
+    }
+
+    noise.GenPositionArray2D(out.data(), count, x.data(), y.data());
+    std::size_t mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        mismatches += !sameBits(out[i], noise.GetNoise(x[i], y[i]));
+    }
+    CHECK(mismatches == 0);
+
+    noise.GenPositionArray3D(out.data(), count, x.data(), y.data(), z.data());
+    mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        mismatches += !sameBits(out[i], noise.GetNoise(x[i], y[i], z[i]));
+    }
+    CHECK(mismatches == 0);
+}
+
+static void matchesGetNoise(FastNoiseLite::NoiseType type) {
+    for (float frequency : {0.005f, 0.05f, 0.08f, 1.0f}) {
+        for (int seed : {1337, -7, 0}) {
+            const FastNoiseLite noise = noiseOf(type, frequency, seed);
+            gridsMatchGetNoise(noise);
+            positionsMatchGetNoise(noise);
+        }
+    }
+}
+
+// 3D OpenSimplex2 is batched under every rotation, 3D Perlin falls back to GetNoise under one
+static void rotationsMatchGetNoise() {
+    for (FastNoiseLite::NoiseType type : {FastNoiseLite::NoiseType_OpenSimplex2, FastNoiseLite::NoiseType_Perlin}) {
+        for (FastNoiseLite::RotationType3D rotation : {FastNoiseLite::RotationType3D_ImproveXYPlanes, FastNoiseLite::RotationType3D_ImproveXZPlanes}) {
+            FastNoiseLite noise = noiseOf(type, 0.05f, 1337);
+            noise.SetRotationType3D(rotation);
+            gridsMatchGetNoise(noise);
+            positionsMatchGetNoise(noise);
+        }
+    }
+}
+
+// Settings without a batched path still fill the output
+static void fallbackMatchesGetNoise() {
+    FastNoiseLite fractal = noiseOf(FastNoiseLite::NoiseType_OpenSimplex2, 0.05f, 1337);
+    fractal.SetFractalType(FastNoiseLite::FractalType_FBm);
+    gridsMatchGetNoise(fractal);
+    gridsMatchGetNoise(noiseOf(FastNoiseLite::NoiseType_Value, 0.05f, 1337));
+}
+
+int main() {
+    matchesGetNoise(FastNoiseLite::NoiseType_Perlin);
+    matchesGetNoise(FastNoiseLite::NoiseType_OpenSimplex2);
+    rotationsMatchGetNoise();
+    fallbackMatchesGetNoise();
+    return testResult();
+}
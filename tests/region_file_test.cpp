@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "region_file.h"
+#include "test.h"
+
+// A region file in a directory of its own, removed again at the end
+struct TempRegion {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / ("region_file_test." + std::to_string(getpid()));
+    std::string path = (directory / "r.0.0.region").string();
+
+    TempRegion() {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+    }
+
+    ~TempRegion() {
+        std::filesystem::remove_all(directory);
+    }
+};
+
+static std::vector<std::uint8_t> record(std::size_t bytes, std::uint8_t seed) {
+    std::vector<std::uint8_t> data(bytes);
+    for (std::size_t i = 0; i < bytes; ++i) {
+        data[i] = static_cast<std::uint8_t>(seed + i * 7);
+    }
+    return data;
+}
+
+static bool holds(RegionFile& file, int x, int z, const std::vector<std::uint8_t>& expected) {
+    return file.read(x, z, [&](const std::uint8_t* data, std::size_t size) {
+        return size == expected.size() && std::equal(data, data + size, expected.begin());
+    });
+}
+
+static void readsBackWhatWasWritten() {
+    TempRegion region;
+    const std::vector<std::uint8_t> first = record(3000, 1), second = record(10, 2);
+    {
+        auto file = RegionFile::open(region.path);
+        CHECK(file != nullptr);
+        CHECK(!file->read(3, 5, [](const std::uint8_t*, std::size_t) { return true; }));
+        CHECK(file->write(3, 5, first.data(), first.size()));
+        CHECK(file->write(REGION_SIZE - 1, REGION_SIZE - 1, second.data(), second.size()));
+        CHECK(holds(*file, 3, 5, first));
+        CHECK(holds(*file, REGION_SIZE - 1, REGION_SIZE - 1, second));
+        CHECK(file->liveSize() == first.size() + second.size());
+    }
+    auto reopened = RegionFile::open(region.path);
+    CHECK(reopened != nullptr);
+    CHECK(holds(*reopened, 3, 5, first));
+    CHECK(holds(*reopened, REGION_SIZE - 1, REGION_SIZE - 1, second));
+    CHECK(reopened->liveSize() == first.size() + second.size());
+}
+
+// Saving the same chunks over and over must not grow the file without bound
+static void compactsDeadRecords() {
+    TempRegion region;
+    const std::vector<std::uint8_t> kept = record(5000, 3);
+    std::vector<std::uint8_t> latest;
+    {
+        auto file = RegionFile::open(region.path);
+        CHECK(file->write(0, 0, kept.data(), kept.size()));
+        for (int i = 0; i < 200; ++i) {
+            latest = record(16 * 1024 + i, static_cast<std::uint8_t>(i));
+            CHECK(file->write(7, 2, latest.data(), latest.size()));
+        }
+        CHECK(file->compactions() > 0);
+        CHECK(file->liveSize() == kept.size() + latest.size());
+        CHECK(file->fileSize() < 64 * 1024 + 2 * REGION_COMPACT_MIN_DEAD_BYTES);
+        CHECK(holds(*file, 0, 0, kept));
+        CHECK(holds(*file, 7, 2, latest));
+    }
+    CHECK(!std::filesystem::exists(region.path + ".compact"));
+    auto reopened = RegionFile::open(region.path);
+    CHECK(reopened != nullptr);
+    CHECK(holds(*reopened, 0, 0, kept));
+    CHECK(holds(*reopened, 7, 2, latest));
+    CHECK(reopened->fileSize() == std::filesystem::file_size(region.path));
+}
+
+// Little dead space is left alone
+static void leavesSmallFilesAlone() {
+    TempRegion region;
+    auto file = RegionFile::open(region.path);
+    const std::vector<std::uint8_t> data = record(1000, 4);
+    for (int i = 0; i < 10; ++i) {
+        CHECK(file->write(1, 1, data.data(), data.size()));
+    }
+    CHECK(file->compactions() == 0);
+    CHECK(holds(*file, 1, 1, data));
+}
+
+int main() {
+    readsBackWhatWasWritten();
+    compactsDeadRecords();
+    leavesSmallFilesAlone();
+    return testResult();
+}
@@ -0,0 +1,133 @@
+#include <string>
+#include <vector>
+#include "render_state.h"
+#include "test.h"
+
+// A few GL enums, the tracker only passes them through
+constexpr std::uint32_t ARRAY_BUFFER = 0x8892;
+constexpr std::uint32_t UNIFORM_BUFFER = 0x8A11;
+constexpr std::uint32_t TEXTURE_2D = 0x0DE1;
+constexpr std::uint32_t DEPTH_TEST = 0x0B71;
+constexpr std::uint32_t BLEND = 0x0BE2;
+
+// Every call that reaches the backend, as text
+class RecordingRenderBackend : public RenderStateBackend {
+public:
+    std::vector<std::string> calls;
+    std::uint32_t samplersCreated = 0;
+
+    void useProgram(std::uint32_t program) override { record("useProgram", program); }
+    void bindVertexArray(std::uint32_t vertexArray) override { record("bindVertexArray", vertexArray); }
+    void bindBuffer(std::uint32_t target, std::uint32_t buffer) override { record("bindBuffer", target, buffer); }
+    void activeTexture(std::uint32_t unit) override { record("activeTexture", unit); }
+    void bindTexture(std::uint32_t target, std::uint32_t texture) override { record("bindTexture", target, texture); }
+    void bindSampler(std::uint32_t unit, std::uint32_t sampler) override { record("bindSampler", unit, sampler); }
+    void setCapability(std::uint32_t capability, bool enabled) override { record("setCapability", capability, enabled); }
+    void blendFunc(std::uint32_t source, std::uint32_t destination) override { record("blendFunc", source, destination); }
+
+    std::uint32_t createSampler(const SamplerState&) override {
+        record("createSampler", samplersCreated + 1);
+        return ++samplersCreated;
+    }
+
+    // Calls since the last take()
+    std::vector<std::string> take() {
+        std::vector<std::string> result;
+        result.swap(calls);
+        return result;
+    }
+
+private:
+    void record(const char* name, std::uint32_t a, std::uint32_t b = 0) {
+        calls.push_back(std::string(name) + " " + std::to_string(a) + " " + std::to_string(b));
+    }
+};
+
+using Calls = std::vector<std::string>;
+
+static void dropsRedundantCalls() {
+    RecordingRenderBackend backend;
+    RenderState state(backend);
+    state.useProgram(3);
+    state.useProgram(3);
+    state.bindVertexArray(7);
+    state.bindVertexArray(7);
+    state.bindBuffer(ARRAY_BUFFER, 1);
+    state.bindBuffer(UNIFORM_BUFFER, 1); // Another target, tracked separately
+    state.bindBuffer(ARRAY_BUFFER, 1);
+    state.enable(DEPTH_TEST);
+    state.enable(DEPTH_TEST);
+    state.disable(BLEND);
+    state.blendFunc(1, 2);
+    state.blendFunc(1, 2);
+    state.bindSampler(0, 9);
+    state.bindSampler(0, 9);
+    CHECK(backend.take() == Calls({"useProgram 3 0", "bindVertexArray 7 0", "bindBuffer 34962 1", "bindBuffer 35345 1",
+                                   "setCapability 2929 1", "setCapability 3042 0", "blendFunc 1 2", "bindSampler 0 9"}));
+
+    state.useProgram(4);
+    state.disable(DEPTH_TEST);
+    CHECK(backend.take() == Calls({"useProgram 4 0", "setCapability 2929 0"}));
+
+    state.beginFrame();
+    const RenderStateStats stats = state.lastFrame();
+    CHECK(stats.issued == 10);
+    CHECK(stats.elided == 6);
+    state.beginFrame();
+    CHECK(state.lastFrame().issued == 0 && state.lastFrame().elided == 0);
+}
+
+// The active unit only changes when a texture binding does, and binding units are remembered per unit
+static void switchesTextureUnitsOnlyWhenNeeded() {
+    RecordingRenderBackend backend;
+    RenderState state(backend);
+    state.bindTexture(0, TEXTURE_2D, 5);
+    state.bindTexture(1, TEXTURE_2D, 6);
+    state.bindTexture(0, TEXTURE_2D, 5); // Already bound on unit 0, unit 1 stays active
+    state.bindTexture(1, TEXTURE_2D, 8);
+    state.bindTexture(0, TEXTURE_2D, 7);
+    CHECK(backend.take() == Calls({"activeTexture 0 0", "bindTexture 3553 5", "activeTexture 1 0", "bindTexture 3553 6",
+                                   "bindTexture 3553 8", "activeTexture 0 0", "bindTexture 3553 7"}));
+}
+
+static void createsEachSamplerOnce() {
+    RecordingRenderBackend backend;
+    RenderState state(backend);
+    const SamplerState nearest{0x2600, 0x2600, 0x812F, 0x812F};
+    const SamplerState linear{0x2601, 0x2601, 0x812F, 0x812F};
+    const std::uint32_t first = state.sampler(nearest);
+    CHECK(state.sampler(nearest) == first);
+    CHECK(state.sampler(linear) != first);
+    CHECK(backend.samplersCreated == 2);
+}
+
+// After invalidate() every piece of state goes through again, once
+static void invalidateForgetsEverything() {
+    RecordingRenderBackend backend;
+    RenderState state(backend);
+    auto bindAll = [&state] {
+        state.useProgram(3);
+        state.bindVertexArray(7);
+        state.bindBuffer(ARRAY_BUFFER, 1);
+        state.bindTexture(2, TEXTURE_2D, 5);
+        state.bindSampler(2, 9);
+        state.enable(DEPTH_TEST);
+        state.blendFunc(1, 2);
+    };
+    bindAll();
+    const Calls first = backend.take();
+    CHECK(first.size() == 8);
+    bindAll();
+    CHECK(backend.take().empty());
+    state.invalidate();
+    bindAll();
+    CHECK(backend.take() == first);
+}
+
+int main() {
+    dropsRedundantCalls();
+    switchesTextureUnitsOnlyWhenNeeded();
+    createsEachSamplerOnce();
+    invalidateForgetsEverything();
+    return testResult();
+}
@@ -0,0 +1,208 @@
+#include <bit>
+#include <map>
+#include <tuple>
+#include "section_visibility.h"
+#include "test.h"
+
+constexpr int MID = SECTION_SIZE / 2;
+constexpr int LAST = SECTION_SIZE - 1;
+
+// The open blocks of one section, indexed like computeSectionConnectivity() expects
+struct Layout {
+    bool open[SECTION_VOLUME] = {};
+
+    void carve(int x, int y, int z) {
+        open[(x * SECTION_SIZE + z) * SECTION_SIZE + y] = true;
+    }
+};
+
+static int connectedPairs(SectionConnectivity connectivity) {
+    int pairs = 0;
+    for (int a = 0; a < 6; ++a) {
+        for (int b = a + 1; b < 6; ++b) {
+            pairs += connectivity.connects(static_cast<FaceDirection>(a), static_cast<FaceDirection>(b));
+        }
+    }
+    return pairs;
+}
+
+static void solidAndEmptySections() {
+    Layout solid;
+    CHECK(computeSectionConnectivity(solid.open).bits == 0);
+
+    Layout empty;
+    for (bool& open : empty.open) open = true;
+    CHECK(connectedPairs(computeSectionConnectivity(empty.open)) == 15);
+
+    // A cave that touches no face connects nothing
+    Layout pocket;
+    for (int x = 4; x < 12; ++x) {
+        for (int y = 4; y < 12; ++y) {
+            for (int z = 4; z < 12; ++z) pocket.carve(x, y, z);
+        }
+    }
+    CHECK(computeSectionConnectivity(pocket.open).bits == 0);
+}
+
+static void straightTunnel() {
+    Layout tunnel;
+    for (int x = 0; x < SECTION_SIZE; ++x) tunnel.carve(x, MID, MID);
+    const SectionConnectivity connectivity = computeSectionConnectivity(tunnel.open);
+    CHECK(connectivity.connects(FACE_NEG_X, FACE_POS_X));
+    CHECK(connectivity.connects(FACE_POS_X, FACE_NEG_X));
+    CHECK(connectedPairs(connectivity) == 1);
+}
+
+static void lShapedTunnel() {
+    Layout tunnel;
+    for (int x = 0; x <= MID; ++x) tunnel.carve(x, MID, MID);
+    for (int z = MID; z < SECTION_SIZE; ++z) tunnel.carve(MID, MID, z);
+    const SectionConnectivity connectivity = computeSectionConnectivity(tunnel.open);
+    CHECK(connectivity.connects(FACE_NEG_X, FACE_POS_Z));
+    CHECK(!connectivity.connects(FACE_NEG_X, FACE_POS_X));
+    CHECK(connectedPairs(connectivity) == 1);
+}
+
+// A staircase rising along x, each step joined to the next through a face, from the bottom of the -X face to the top
+// of the +X face
+static void diagonalTunnel() {
+    Layout stairs;
+    for (int i = 0; i < SECTION_SIZE; ++i) {
+        stairs.carve(i, i, MID);
+        if (i < LAST) stairs.carve(i + 1, i, MID);
+    }
+    const SectionConnectivity connectivity = computeSectionConnectivity(stairs.open);
+    CHECK(connectivity.connects(FACE_NEG_X, FACE_POS_X));
+    CHECK(connectivity.connects(FACE_NEG_Y, FACE_POS_Y));
+    CHECK(connectivity.connects(FACE_NEG_X, FACE_POS_Y));
+    CHECK(!connectivity.connects(FACE_NEG_Z, FACE_POS_Z));
+    CHECK(!connectivity.connects(FACE_NEG_X, FACE_NEG_Z));
+    CHECK(connectedPairs(connectivity) == 6); // Every pair of the four faces it touches
+
+    // One block diagonal gaps don't count, blocks only join through faces
+    Layout gaps;
+    for (int i = 0; i < SECTION_SIZE; ++i) gaps.carve(i, i, MID);
+    const SectionConnectivity gapped = computeSectionConnectivity(gaps.open);
+    CHECK(!gapped.connects(FACE_NEG_X, FACE_POS_X));
+    CHECK(gapped.connects(FACE_NEG_X, FACE_NEG_Y)); // The corner block alone touches both
+}
+
+static void separateTunnelsDontJoin() {
+    Layout tunnels;
+    for (int i = 0; i < SECTION_SIZE; ++i) {
+        tunnels.carve(i, 4, MID);
+        tunnels.carve(MID, 12, i);
+    }
+    const SectionConnectivity connectivity = computeSectionConnectivity(tunnels.open);
+    CHECK(connectivity.connects(FACE_NEG_X, FACE_POS_X));
+    CHECK(connectivity.connects(FACE_NEG_Z, FACE_POS_Z));
+    CHECK(!connectivity.connects(FACE_NEG_X, FACE_POS_Z));
+    CHECK(connectedPairs(connectivity) == 2);
+}
+
+// Sections of a small synthetic world, anything not in it is unloaded
+struct World {
+    std::map<std::tuple<int, int, int>, SectionConnectivity> sections;
+
+    void fill(int radius, int sectionsPerChunk, SectionConnectivity connectivity) {
+        for (int x = -radius; x <= radius; ++x) {
+            for (int z = -radius; z <= radius; ++z) {
+                for (int y = 0; y < sectionsPerChunk; ++y) sections[{x, y, z}] = connectivity;
+            }
+        }
+    }
+
+    const SectionConnectivity* operator()(int chunkX, int sectionY, int chunkZ) const {
+        auto it = sections.find({chunkX, sectionY, chunkZ});
+        return it == sections.end() ? nullptr : &it->second;
+    }
+};
+
+static bool isVisible(const VisibleSections& visible, int chunkX, int sectionY, int chunkZ) {
+    auto it = visible.find({chunkX, chunkZ});
+    return it != visible.end() && (it->second >> sectionY & 1);
+}
+
+static std::size_t countVisible(const VisibleSections& visible) {
+    std::size_t count = 0;
+    for (const auto& [position, mask] : visible) count += std::popcount(mask);
+    return count;
+}
+
+constexpr int SECTIONS = 4;
+const glm::vec3 CAMERA(MID, SECTION_SIZE + MID, MID); // Chunk (0, 0), section 1
+
+static void openWorldIsAllVisible() {
+    World world;
+    world.fill(2, SECTIONS, SectionConnectivity::all());
+    VisibleSections visible;
+    CHECK(findVisibleSections(CAMERA, SECTIONS, 2, world, visible));
+    CHECK(countVisible(visible) == world.sections.size());
+}
+
+// Solid sections are still entered, their faces towards the camera are what gets drawn, but nothing beyond them
+static void solidWorldStopsAtNeighbours() {
+    World world;
+    world.fill(2, SECTIONS, SectionConnectivity{});
+    VisibleSections visible;
+    CHECK(findVisibleSections(CAMERA, SECTIONS, 2, world, visible));
+    CHECK(countVisible(visible) == 7);
+    CHECK(isVisible(visible, 0, 1, 0));
+    CHECK(isVisible(visible, 1, 1, 0) && isVisible(visible, -1, 1, 0));
+    CHECK(isVisible(visible, 0, 0, 0) && isVisible(visible, 0, 2, 0));
+    CHECK(!isVisible(visible, 2, 1, 0));
+}
+
+// A tunnel leading along +X, turning to +Z at chunk 3. Sections beside the tunnel are only seen next to the camera.
+static void walkFollowsTunnels() {
+    World world;
+    world.fill(5, SECTIONS, SectionConnectivity{});
+    SectionConnectivity alongX, alongZ, turn;
+    alongX.connect(FACE_NEG_X, FACE_POS_X);
+    alongZ.connect(FACE_NEG_Z, FACE_POS_Z);
+    turn.connect(FACE_NEG_X, FACE_POS_Z);
+    for (int x = 1; x < 3; ++x) world.sections[{x, 1, 0}] = alongX;
+    world.sections[{3, 1, 0}] = turn;
+    for (int z = 1; z <= 5; ++z) world.sections[{3, 1, z}] = alongZ;
+
+    VisibleSections visible;
+    CHECK(findVisibleSections(CAMERA, SECTIONS, 5, world, visible));
+    CHECK(isVisible(visible, 3, 1, 0));
+    CHECK(isVisible(visible, 3, 1, 5));
+    CHECK(!isVisible(visible, 4, 1, 0));        // Past the turn, which doesn't lead on along +X
+    CHECK(!isVisible(visible, 2, 1, 1));        // Beside the tunnel
+    CHECK(!isVisible(visible, 3, 2, 3));        // Above the tunnel
+    CHECK(countVisible(visible) == 7 + 1 + 1 + 5); // Around the camera, x = 2, the turn, z = 1 to 5
+}
+
+static void nothingToStartFrom() {
+    World world;
+    VisibleSections visible;
+    CHECK(!findVisibleSections(CAMERA, SECTIONS, 2, world, visible));
+}
+
+// From above the world the walk starts at the top layer of every chunk in range and goes down
+static void cameraAboveTheWorld() {
+    World world;
+    world.fill(3, SECTIONS, SectionConnectivity{});
+    VisibleSections visible;
+    CHECK(findVisibleSections(glm::vec3(MID, SECTIONS * SECTION_SIZE + 40, MID), SECTIONS, 2, world, visible));
+    CHECK(countVisible(visible) == 5 * 5);
+    CHECK(isVisible(visible, -2, SECTIONS - 1, 2));
+    CHECK(!isVisible(visible, 0, SECTIONS - 2, 0));
+    CHECK(!isVisible(visible, 3, SECTIONS - 1, 0));
+}
+
+int main() {
+    solidAndEmptySections();
+    straightTunnel();
+    lShapedTunnel();
+    diagonalTunnel();
+    separateTunnelsDontJoin();
+    openWorldIsAllVisible();
+    solidWorldStopsAtNeighbours();
+    walkFollowsTunnels();
+    nothingToStartFrom();
+    cameraAboveTheWorld();
+    return testResult();
+}
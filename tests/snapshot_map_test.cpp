@@ -0,0 +1,127 @@
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+#include "chunk_index.h"
+#include "snapshot_map.h"
+#include "test.h"
+
+// Stands in for Chunk, with contents derived from its position so a reader can tell it is intact
+struct FakeChunk {
+    ChunkPosition position;
+    std::vector<int> blocks;
+    bool destroyed = false;
+
+    explicit FakeChunk(ChunkPosition position) : position(position), blocks(256, position.first * 1000 + position.second) {}
+    ~FakeChunk() {
+        destroyed = true; // Poisoned, so a reader that still sees it after this is caught
+    }
+
+    bool intact(ChunkPosition at) const {
+        if (destroyed || position != at) return false;
+        for (int block : blocks) {
+            if (block != at.first * 1000 + at.second) return false;
+        }
+        return true;
+    }
+};
+
+using FakeChunkMap = SnapshotMap<ChunkPosition, FakeChunk, ChunkIndex<std::shared_ptr<FakeChunk>>>;
+
+// A reader that took its snapshot before an update() erased every chunk still walks all of them afterwards
+static void oldSnapshotKeepsErasedChunksAlive() {
+    constexpr int SIZE = 8;
+    FakeChunkMap map;
+    map.update([](FakeChunkMap::Writer& writer) {
+        for (int x = -SIZE / 2; x < SIZE / 2; ++x) {
+            for (int z = -SIZE / 2; z < SIZE / 2; ++z) {
+                writer.tryEmplace(ChunkPosition(x, z), ChunkPosition(x, z));
+            }
+        }
+    });
+    const SlabHandle handle = FakeChunkMap::handle(*map.find(ChunkPosition(1, -2)));
+
+    std::promise<void> held;
+    std::promise<void> erased;
+    std::shared_future<void> erasedFuture = erased.get_future().share();
+    std::atomic<int> intactChunks{0};
+    std::atomic<bool> goneFromMap{true};
+    std::thread reader([&] {
+        const std::shared_ptr<const FakeChunkMap::Entries> snapshot = map.snapshot();
+        held.set_value();
+        erasedFuture.wait();
+        for (const auto& [position, chunk] : *snapshot) {
+            intactChunks += chunk->intact(position);
+            goneFromMap = goneFromMap && map.find(position) == nullptr;
+        }
+    });
+
+    held.get_future().wait();
+    map.update([](FakeChunkMap::Writer& writer) {
+        for (int x = -SIZE / 2; x < SIZE / 2; ++x) {
+            for (int z = -SIZE / 2; z < SIZE / 2; ++z) {
+                writer.erase(ChunkPosition(x, z));
+            }
+        }
+    });
+    CHECK(map.stats().entries == 0);
+    CHECK(map.stats().retired == SIZE * SIZE);
+    CHECK(map.alive(handle));
+    erased.set_value();
+    reader.join();
+
+    CHECK(intactChunks == SIZE * SIZE);
+    CHECK(goneFromMap);
+    // The reader's snapshot was the last reference
+    CHECK(map.stats().retired == 0);
+    CHECK(!map.alive(handle));
+    CHECK(map.stats().version == 2);
+}
+
+// Readers never see a chunk destroyed or half built while a writer keeps loading and unloading them
+static void readersSurviveChurn() {
+    constexpr int COLUMNS = 16;
+    constexpr int UPDATES = 2000;
+    FakeChunkMap map;
+    std::atomic<bool> done{false};
+    std::atomic<int> broken{0};
+
+    auto read = [&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            const std::shared_ptr<const FakeChunkMap::Entries> snapshot = map.snapshot();
+            for (const auto& [position, chunk] : *snapshot) {
+                broken += !chunk->intact(position);
+            }
+            if (const std::shared_ptr<FakeChunk> chunk = map.find(ChunkPosition(-3, 5))) {
+                broken += !chunk->intact(ChunkPosition(-3, 5));
+            }
+        }
+    };
+    std::thread first(read);
+    std::thread second(read);
+
+    for (int i = 0; i < UPDATES; ++i) {
+        map.update([i](FakeChunkMap::Writer& writer) {
+            const int x = i % COLUMNS - COLUMNS / 2;
+            for (int z = -COLUMNS / 2; z < COLUMNS / 2; ++z) {
+                if (i % 2 == 0) {
+                    writer.tryEmplace(ChunkPosition(x, z), ChunkPosition(x, z));
+                } else {
+                    writer.erase(ChunkPosition(x - 1, z));
+                }
+            }
+        });
+    }
+    done = true;
+    first.join();
+    second.join();
+
+    CHECK(broken == 0);
+    CHECK(map.stats().retired == 0);
+}
+
+int main() {
+    oldSnapshotKeepsErasedChunksAlive();
+    readersSurviveChurn();
+    return testResult();
+}
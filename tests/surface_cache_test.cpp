@@ -0,0 +1,98 @@
+#include <thread>
+#include <vector>
+#include "surface_cache.h"
+#include "test.h"
+
+constexpr int SEED = 12345;
+constexpr int MAX_HEIGHT = 128;
+
+static void regionsSplitTheWorldIntoTiles() {
+    CHECK(SurfaceCache::regionOf(0) == 0 && SurfaceCache::localOf(0) == 0);
+    CHECK(SurfaceCache::regionOf(SURFACE_TILE_SIZE - 1) == 0 && SurfaceCache::localOf(SURFACE_TILE_SIZE - 1) == SURFACE_TILE_SIZE - 1);
+    CHECK(SurfaceCache::regionOf(SURFACE_TILE_SIZE) == 1 && SurfaceCache::localOf(SURFACE_TILE_SIZE) == 0);
+    // Negative coordinates round down, not towards zero
+    CHECK(SurfaceCache::regionOf(-1) == -1 && SurfaceCache::localOf(-1) == SURFACE_TILE_SIZE - 1);
+    CHECK(SurfaceCache::regionOf(-SURFACE_TILE_SIZE) == -1 && SurfaceCache::localOf(-SURFACE_TILE_SIZE) == 0);
+    CHECK(SurfaceCache::regionOf(-SURFACE_TILE_SIZE - 1) == -2 && SurfaceCache::localOf(-SURFACE_TILE_SIZE - 1) == SURFACE_TILE_SIZE - 1);
+    for (int world = -5 * SURFACE_TILE_SIZE; world <= 5 * SURFACE_TILE_SIZE; ++world) {
+        const int local = SurfaceCache::localOf(world);
+        CHECK(local >= 0 && local < SURFACE_TILE_SIZE);
+        CHECK(SurfaceCache::regionOf(world) * SURFACE_TILE_SIZE + local == world);
+    }
+}
+
+// Columns read one at a time, per chunk and straight from the tile agree, on both sides of the origin
+static void lookupsAgreeAcrossTheOrigin() {
+    SurfaceCache cache(4, MAX_HEIGHT);
+    for (int worldX : {-SURFACE_TILE_SIZE - 16, -16, 0, 48}) {
+        for (int worldZ : {-16, 16}) {
+            ColumnSurface chunk[16 * 16];
+            cache.chunkSurface(SEED, worldX, worldZ, 16, 16, chunk);
+            const std::shared_ptr<const SurfaceTile> tile = cache.tile(SEED, SurfaceCache::regionOf(worldX), SurfaceCache::regionOf(worldZ));
+            for (int x = 0; x < 16; ++x) {
+                for (int z = 0; z < 16; ++z) {
+                    const ColumnSurface single = cache.surfaceAt(SEED, worldX + x, worldZ + z);
+                    const ColumnSurface& inTile = tile->at(SurfaceCache::localOf(worldX + x), SurfaceCache::localOf(worldZ + z));
+                    CHECK(single.height == chunk[x * 16 + z].height && single.height == inTile.height);
+                    CHECK(single.forest == inTile.forest && single.desert == inTile.desert);
+                    CHECK(single.height < MAX_HEIGHT);
+                }
+            }
+        }
+    }
+}
+
+// The least recently used tile goes first, a hit makes a tile the most recently used one
+static void evictsLeastRecentlyUsed() {
+    SurfaceCache cache(2, MAX_HEIGHT);
+    const std::shared_ptr<const SurfaceTile> first = cache.tile(SEED, 0, 0);
+    cache.tile(SEED, 1, 0);
+    cache.tile(SEED, 0, 0); // Hit, (1, 0) is now the oldest
+    cache.tile(SEED, 2, 0); // Evicts (1, 0)
+    SurfaceCacheStats stats = cache.stats();
+    CHECK(stats.tiles == 2);
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 3);
+    CHECK(stats.evictions == 1);
+
+    CHECK(cache.tile(SEED, 0, 0) == first); // Still cached, the same tile
+    CHECK(cache.stats().misses == 3);
+    cache.tile(SEED, 1, 0);                 // Was evicted, computed again and evicts (2, 0)
+    stats = cache.stats();
+    CHECK(stats.misses == 4);
+    CHECK(stats.evictions == 2);
+    cache.tile(SEED, 0, 0);
+    CHECK(cache.stats().misses == 4);
+
+    // Tiles of another seed are other tiles
+    cache.tile(SEED + 1, 0, 0);
+    CHECK(cache.stats().misses == 5);
+}
+
+// Threads asking for the same missing tile at once get one computation between them
+static void computesEachTileOnce() {
+    SurfaceCache cache(4, MAX_HEIGHT);
+    constexpr int threadCount = 8;
+    std::vector<std::shared_ptr<const SurfaceTile>> tiles(threadCount);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&cache, &tiles, i] { tiles[i] = cache.tile(SEED, -3, 7); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const SurfaceCacheStats stats = cache.stats();
+    CHECK(stats.misses == 1);
+    CHECK(stats.hits == threadCount - 1);
+    for (const std::shared_ptr<const SurfaceTile>& tile : tiles) {
+        CHECK(tile == tiles[0]);
+    }
+}
+
+int main() {
+    regionsSplitTheWorldIntoTiles();
+    lookupsAgreeAcrossTheOrigin();
+    evictsLeastRecentlyUsed();
+    computesEachTileOnce();
+    return testResult();
+}
@@ -0,0 +1,22 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <iostream>
+
+// The unit tests under tests/ are plain programs, one per header they cover. A failed check is reported and the
+// program exits non-zero at the end, so ctest marks it failed.
+inline int testFailures = 0;
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            testFailures++;                                                                \
+        }                                                                                  \
+    } while (0)
+
+inline int testResult() {
+    return testFailures == 0 ? 0 : 1;
+}
+
+#endif // TEST_H
@@ -0,0 +1,75 @@
+#include <string>
+#include <utility>
+#include <vector>
+#include "uniform_table.h"
+#include "test.h"
+
+// Every upload that reaches the backend
+class RecordingUniformBackend : public UniformBackend {
+public:
+    std::vector<std::pair<std::string, int>> uniforms; // What the next linked program reports
+    std::vector<std::pair<int, float>> uploads;        // Location and value of every float upload
+    int otherUploads = 0;
+
+    std::vector<std::pair<std::string, int>> activeUniforms(std::uint32_t) override {
+        return uniforms;
+    }
+
+    void upload(int location, UniformKind kind, const void* value) override {
+        if (kind == UniformKind::Float) {
+            uploads.emplace_back(location, *static_cast<const float*>(value));
+        } else {
+            otherUploads++;
+        }
+    }
+};
+
+static void uniformsDropUnchangedValues() {
+    RecordingUniformBackend backend;
+    backend.uniforms = {{"time", 4}, {"tint", 2}, {"unused", -1}};
+    UniformTable table(backend);
+    table.link(1);
+    CHECK(table.size() == 2);
+    const int time = table.slot("time");
+    CHECK(time >= 0);
+    CHECK(table.slot("tint") >= 0 && table.slot("tint") != time);
+    CHECK(table.slot("unused") == -1);
+    CHECK(table.slot("missing") == -1);
+
+    table.set(time, 1.5f);
+    table.set(time, 1.5f);
+    table.set(time, 2.0f);
+    table.set(-1, 3.0f); // Sets nothing
+    CHECK(backend.uploads == (std::vector<std::pair<int, float>>{{4, 1.5f}, {4, 2.0f}}));
+    // The same bytes as another kind are a different value
+    table.set(time, glm::vec2(2.0f, 0.0f));
+    CHECK(backend.otherUploads == 1);
+    CHECK(table.stats().uploads == 3);
+    CHECK(table.stats().unchanged == 1);
+}
+
+static void uniformInvalidateAndRelink() {
+    RecordingUniformBackend backend;
+    backend.uniforms = {{"time", 4}};
+    UniformTable table(backend);
+    table.link(1);
+    table.set(table.slot("time"), 1.0f);
+    table.invalidate();
+    table.set(table.slot("time"), 1.0f); // Goes through again after invalidate()
+    table.set(table.slot("time"), 1.0f);
+    CHECK(backend.uploads.size() == 2);
+
+    // A relinked program has new locations and none of the old values
+    backend.uniforms = {{"scale", 0}, {"time", 9}};
+    table.link(2);
+    CHECK(table.size() == 2);
+    table.set(table.slot("time"), 1.0f);
+    CHECK(backend.uploads.size() == 3 && backend.uploads.back() == std::make_pair(9, 1.0f));
+    CHECK(table.slot("scale") >= 0);
+}
+
+int main() {
+    uniformsDropUnchangedValues();
+    uniformInvalidateAndRelink();
+    return testResult();
+}
@@ -0,0 +1,154 @@
+#include <cstring>
+#include <map>
+#include <vector>
+#include "vertex_heap.h"
+#include "test.h"
+
+// Buffers as byte vectors, so what the heap uploads and copies can be read back
+class FakeBackend : public VertexHeapBackend {
+public:
+    std::map<std::uint32_t, std::vector<unsigned char>> buffers;
+    std::uint32_t nextBuffer = 1;
+    int copies = 0;
+
+    std::uint32_t createBuffer(std::size_t bytes) override {
+        buffers[nextBuffer].assign(bytes, 0);
+        return nextBuffer++;
+    }
+
+    void destroyBuffer(std::uint32_t buffer) override {
+        CHECK(buffers.erase(buffer) == 1);
+    }
+
+    void upload(std::uint32_t buffer, std::size_t offset, const void* data, std::size_t bytes) override {
+        std::vector<unsigned char>& contents = buffers.at(buffer);
+        CHECK(offset + bytes <= contents.size());
+        std::memcpy(contents.data() + offset, data, bytes);
+    }
+
+    void copy(std::uint32_t source, std::uint32_t destination, std::size_t bytes) override {
+        const std::vector<unsigned char>& from = buffers.at(source);
+        std::vector<unsigned char>& to = buffers.at(destination);
+        CHECK(bytes <= from.size() && bytes <= to.size());
+        std::memcpy(to.data(), from.data(), bytes);
+        copies++;
+    }
+
+    unsigned char at(std::uint32_t buffer, std::size_t offset) const {
+        return buffers.at(buffer).at(offset);
+    }
+};
+
+static std::vector<unsigned char> bytes(std::size_t count, unsigned char value) {
+    return std::vector<unsigned char>(count, value);
+}
+
+static void allocatesAlignedSlicesInOrder() {
+    FakeBackend backend;
+    VertexHeap heap(backend, 1024, 8);
+    const std::vector<unsigned char> data = bytes(13, 0xAB);
+    const VertexHeapAllocation first = heap.allocate(data.size(), data.data());
+    const VertexHeapAllocation second = heap.allocate(8);
+    CHECK(first.offset == 0 && first.size == 16); // 13 rounded up to the alignment
+    CHECK(second.offset == 16 && second.size == 8);
+    CHECK(backend.at(heap.buffer(), 0) == 0xAB && backend.at(heap.buffer(), 12) == 0xAB);
+    CHECK(backend.at(heap.buffer(), 13) == 0); // Padding isn't written
+
+    const VertexHeapAllocation empty = heap.allocate(0);
+    CHECK(empty.size == 0);
+    heap.free(empty);
+
+    const VertexHeapStats stats = heap.stats();
+    CHECK(stats.capacity == 1024);
+    CHECK(stats.used == 24);
+    CHECK(stats.allocations == 2);
+    CHECK(stats.freeBlocks == 1);
+    CHECK(stats.largestFreeBlock == 1000);
+    CHECK(stats.fragmentation() == 0.0);
+}
+
+// Freed slices merge with the holes on both sides, so freeing everything leaves one hole again
+static void freeingCoalesces() {
+    FakeBackend backend;
+    VertexHeap heap(backend, 256, 16);
+    const VertexHeapAllocation a = heap.allocate(64);
+    const VertexHeapAllocation b = heap.allocate(64);
+    const VertexHeapAllocation c = heap.allocate(64);
+    heap.free(a);
+    heap.free(c); // Merges with the space after it
+    CHECK(heap.stats().freeBlocks == 2);
+    CHECK(heap.stats().largestFreeBlock == 128);
+    CHECK(heap.stats().fragmentation() > 0.0);
+    heap.free(b); // Merges with the holes on both sides
+    const VertexHeapStats stats = heap.stats();
+    CHECK(stats.freeBlocks == 1);
+    CHECK(stats.largestFreeBlock == 256);
+    CHECK(stats.used == 0 && stats.allocations == 0);
+}
+
+// Allocation takes the smallest hole that fits, so a freed slice is reused by the next one of its size
+static void reusesFreedBlocks() {
+    FakeBackend backend;
+    VertexHeap heap(backend, 1024, 16);
+    const VertexHeapAllocation small = heap.allocate(32);
+    heap.allocate(16);
+    const VertexHeapAllocation large = heap.allocate(128);
+    heap.allocate(16);
+    heap.free(large);
+    heap.free(small);
+
+    const VertexHeapAllocation reused = heap.allocate(32);
+    CHECK(reused.offset == small.offset);
+    const VertexHeapAllocation fits = heap.allocate(100);
+    CHECK(fits.offset == large.offset); // The 128 byte hole, not the space at the end
+    CHECK(heap.stats().freeBlocks == 2); // What is left of it, and the end
+    CHECK(heap.stats().grows == 0);
+}
+
+// When nothing fits the buffer doubles and keeps its contents, slices keep their offsets
+static void growsByCopying() {
+    FakeBackend backend;
+    VertexHeap heap(backend, 64, 16);
+    const std::uint32_t original = heap.buffer();
+    const std::vector<unsigned char> data = bytes(48, 0x5A);
+    const VertexHeapAllocation kept = heap.allocate(data.size(), data.data());
+
+    const std::vector<unsigned char> more = bytes(40, 0x33);
+    const VertexHeapAllocation added = heap.allocate(more.size(), more.data());
+    CHECK(heap.buffer() != original);
+    CHECK(backend.buffers.count(original) == 0); // The old buffer is gone
+    CHECK(backend.copies == 1);
+    CHECK(kept.offset == 0);
+    CHECK(added.offset == 48); // The hole the old buffer ended in, merged with the new space
+    CHECK(backend.at(heap.buffer(), 0) == 0x5A && backend.at(heap.buffer(), 47) == 0x5A);
+    CHECK(backend.at(heap.buffer(), 48) == 0x33 && backend.at(heap.buffer(), 87) == 0x33);
+    VertexHeapStats stats = heap.stats();
+    CHECK(stats.capacity == 128);
+    CHECK(stats.grows == 1);
+    CHECK(stats.freeBlocks == 1 && stats.largestFreeBlock == 128 - 96);
+
+    // A request larger than twice the capacity grows as often as it takes in one go
+    heap.allocate(1000);
+    stats = heap.stats();
+    CHECK(stats.capacity == 2048);
+    CHECK(stats.grows == 2);
+    CHECK(backend.copies == 2);
+}
+
+static void destroysItsBuffer() {
+    FakeBackend backend;
+    {
+        VertexHeap heap(backend, 64, 16);
+        heap.allocate(200);
+    }
+    CHECK(backend.buffers.empty());
+}
+
+int main() {
+    allocatesAlignedSlicesInOrder();
+    freeingCoalesces();
+    reusesFreedBlocks();
+    growsByCopying();
+    destroysItsBuffer();
+    return testResult();
+}
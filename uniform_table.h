@@ -0,0 +1,150 @@
+#ifndef UNIFORM_TABLE_H
+#define UNIFORM_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+enum class UniformKind {
+    Int, // Also bools and samplers
+    Float,
+    Vec2,
+    Vec3,
+    Vec4,
+    Mat2,
+    Mat3,
+    Mat4
+};
+
+// Which kind a C++ value is uploaded as, and how many bytes of it the table keeps to compare against
+template <typename T> struct UniformTraits;
+template <> struct UniformTraits<int> { static constexpr UniformKind kind = UniformKind::Int; };
+template <> struct UniformTraits<float> { static constexpr UniformKind kind = UniformKind::Float; };
+template <> struct UniformTraits<glm::vec2> { static constexpr UniformKind kind = UniformKind::Vec2; };
+template <> struct UniformTraits<glm::vec3> { static constexpr UniformKind kind = UniformKind::Vec3; };
+template <> struct UniformTraits<glm::vec4> { static constexpr UniformKind kind = UniformKind::Vec4; };
+template <> struct UniformTraits<glm::mat2> { static constexpr UniformKind kind = UniformKind::Mat2; };
+template <> struct UniformTraits<glm::mat3> { static constexpr UniformKind kind = UniformKind::Mat3; };
+template <> struct UniformTraits<glm::mat4> { static constexpr UniformKind kind = UniformKind::Mat4; };
+
+// What the uniform table needs from the graphics API, so the table can run against a fake one without a GL context
+class UniformBackend {
+public:
+    virtual ~UniformBackend() = default;
+
+    // Name and location of every active uniform of a linked program, arrays by the name without "[0]"
+    virtual std::vector<std::pair<std::string, int>> activeUniforms(std::uint32_t program) = 0;
+    // Sets a uniform of the program in use, value points at a value of the C++ type for kind
+    virtual void upload(int location, UniformKind kind, const void* value) = 0;
+};
+
+// FNV-1a, constexpr so names written as literals hash at compile time
+constexpr std::uint64_t uniformNameHash(std::string_view name) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// A uniform resolved once, set without looking its name up again. Default constructed or for a name the program
+// doesn't use it sets nothing, like location -1 in GL.
+template <typename T>
+struct Uniform {
+    int slot = -1;
+};
+
+struct UniformStats {
+    std::uint64_t uploads = 0;   // Values sent to the driver
+    std::uint64_t unchanged = 0; // Sets skipped because the program already had the value
+
+    UniformStats& operator+=(const UniformStats& other) {
+        uploads += other.uploads;
+        unchanged += other.unchanged;
+        return *this;
+    }
+};
+
+// The active uniforms of one program, resolved when it is linked, with the last value sent to each. Uniform values
+// belong to the program and survive switching programs, so a set to the value the program already has is dropped.
+// Like glUniform* itself, sets only reach the program that is in use, which the caller has to make sure of.
+class UniformTable {
+public:
+    explicit UniformTable(UniformBackend& backend) : backend(&backend) {}
+
+    // Looks up every active uniform of a freshly linked program, forgetting values sent to a previous one
+    void link(std::uint32_t program) {
+        entries.clear();
+        for (auto& [name, location] : backend->activeUniforms(program)) {
+            if (location >= 0) {
+                entries.push_back({uniformNameHash(name), std::move(name), location});
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+    }
+
+    // Index of the named uniform for set(), -1 if the program has no such active uniform
+    int slot(std::string_view name) const {
+        const std::uint64_t hash = uniformNameHash(name);
+        auto it = std::lower_bound(entries.begin(), entries.end(), hash, [](const Entry& entry, std::uint64_t h) { return entry.hash < h; });
+        for (; it != entries.end() && it->hash == hash; ++it) {
+            if (it->name == name) {
+                return static_cast<int>(it - entries.begin());
+            }
+        }
+        return -1;
+    }
+
+    template <typename T>
+    void set(int slot, const T& value) {
+        static_assert(sizeof(T) <= sizeof(Entry::value), "Uniform value too large to cache");
+        if (slot < 0) return;
+        Entry& entry = entries[slot];
+        if (entry.sent && entry.kind == UniformTraits<T>::kind && std::memcmp(entry.value, &value, sizeof(T)) == 0) {
+            counters.unchanged++;
+            return;
+        }
+        backend->upload(entry.location, UniformTraits<T>::kind, &value);
+        std::memcpy(entry.value, &value, sizeof(T));
+        entry.kind = UniformTraits<T>::kind;
+        entry.sent = true;
+        counters.uploads++;
+    }
+
+    // Makes the next set of every uniform reach the driver, for when something else may have changed them
+    void invalidate() {
+        for (Entry& entry : entries) {
+            entry.sent = false;
+        }
+    }
+
+    std::size_t size() const {
+        return entries.size();
+    }
+
+    UniformStats stats() const {
+        return counters;
+    }
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        std::string name;
+        int location;
+        bool sent = false;
+        UniformKind kind = UniformKind::Int;
+        alignas(16) unsigned char value[sizeof(glm::mat4)] = {}; // Last value sent, as kind's C++ type
+    };
+
+    UniformBackend* backend;
+    std::vector<Entry> entries; // By hash
+    UniformStats counters;
+};
+
+#endif // UNIFORM_TABLE_H
@@ -0,0 +1,173 @@
+#ifndef VERTEX_HEAP_H
+#define VERTEX_HEAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <optional>
+
+// What the heap needs from the graphics API. The heap only ever talks to its backend, so the allocator can run
+// against a fake one without a GL context.
+class VertexHeapBackend {
+public:
+    virtual ~VertexHeapBackend() = default;
+
+    virtual std::uint32_t createBuffer(std::size_t bytes) = 0;
+    virtual void destroyBuffer(std::uint32_t buffer) = 0;
+    virtual void upload(std::uint32_t buffer, std::size_t offset, const void* data, std::size_t bytes) = 0;
+    virtual void copy(std::uint32_t source, std::uint32_t destination, std::size_t bytes) = 0; // From offset 0 to offset 0
+};
+
+// A slice of the heap's buffer, offset and size in bytes
+struct VertexHeapAllocation {
+    std::size_t offset = 0;
+    std::size_t size = 0;
+};
+
+struct VertexHeapStats {
+    std::size_t capacity = 0;         // Bytes in the buffer
+    std::size_t used = 0;             // Bytes handed out, alignment padding included
+    std::size_t allocations = 0;      // Live slices
+    std::size_t freeBlocks = 0;       // Holes between and after the slices
+    std::size_t largestFreeBlock = 0;
+    std::size_t grows = 0;            // Times the buffer was reallocated larger
+
+    // 0 while all free space is one block, towards 1 the more it is scattered over small holes
+    double fragmentation() const {
+        const std::size_t free = capacity - used;
+        return free == 0 ? 0.0 : 1.0 - static_cast<double>(largestFreeBlock) / static_cast<double>(free);
+    }
+};
+
+// One big vertex buffer handed out in slices. Free space is kept as an offset ordered list of holes, allocation
+// takes the smallest hole that fits and freeing merges a slice with the holes on either side. When nothing fits
+// the buffer is recreated at twice the size and the old contents are copied over, so existing offsets stay valid.
+class VertexHeap {
+public:
+    VertexHeap(VertexHeapBackend& backend, std::size_t initialCapacity, std::size_t alignment)
+        : backend(backend), alignment(alignment) {
+        capacity = alignUp(std::max<std::size_t>(initialCapacity, alignment));
+        bufferId = backend.createBuffer(capacity);
+        freeBlocks[0] = capacity;
+    }
+
+    ~VertexHeap() {
+        backend.destroyBuffer(bufferId);
+    }
+
+    VertexHeap(const VertexHeap&) = delete;
+    VertexHeap& operator=(const VertexHeap&) = delete;
+
+    // Reserves at least bytes and fills them with data, null data only reserves. Empty requests get an empty slice.
+    VertexHeapAllocation allocate(std::size_t bytes, const void* data = nullptr) {
+        if (bytes == 0) return {};
+        const std::size_t size = alignUp(bytes);
+        std::optional<std::size_t> offset = takeFreeBlock(size);
+        while (!offset) {
+            grow(capacity + size);
+            offset = takeFreeBlock(size);
+        }
+        used += size;
+        ++allocations;
+        if (data != nullptr) {
+            backend.upload(bufferId, *offset, data, bytes);
+        }
+        return {*offset, size};
+    }
+
+    void free(const VertexHeapAllocation& allocation) {
+        if (allocation.size == 0) return;
+        used -= allocation.size;
+        --allocations;
+        insertFreeBlock(allocation.offset, allocation.size);
+    }
+
+    std::uint32_t buffer() const {
+        return bufferId;
+    }
+
+    VertexHeapStats stats() const {
+        VertexHeapStats result;
+        result.capacity = capacity;
+        result.used = used;
+        result.allocations = allocations;
+        result.freeBlocks = freeBlocks.size();
+        result.grows = grows;
+        for (const auto& [offset, size] : freeBlocks) {
+            result.largestFreeBlock = std::max(result.largestFreeBlock, size);
+        }
+        return result;
+    }
+
+private:
+    VertexHeapBackend& backend;
+    std::size_t alignment;
+    std::size_t capacity = 0;
+    std::size_t used = 0;
+    std::size_t allocations = 0;
+    std::size_t grows = 0;
+    std::uint32_t bufferId = 0;
+    std::map<std::size_t, std::size_t> freeBlocks; // Offset -> size of every hole, never two adjacent ones
+
+    std::size_t alignUp(std::size_t bytes) const {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    // Adds a hole, merged with the holes directly before and after it
+    void insertFreeBlock(std::size_t offset, std::size_t size) {
+        auto next = freeBlocks.lower_bound(offset);
+        if (next != freeBlocks.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                freeBlocks.erase(previous);
+            }
+        }
+        if (next != freeBlocks.end() && offset + size == next->first) {
+            size += next->second;
+            freeBlocks.erase(next);
+        }
+        freeBlocks[offset] = size;
+    }
+
+    // Best fit, the remainder of the hole stays free
+    std::optional<std::size_t> takeFreeBlock(std::size_t size) {
+        auto best = freeBlocks.end();
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            if (it->second >= size && (best == freeBlocks.end() || it->second < best->second)) {
+                best = it;
+                if (best->second == size) break;
+            }
+        }
+        if (best == freeBlocks.end()) return std::nullopt;
+
+        const std::size_t offset = best->first;
+        const std::size_t remaining = best->second - size;
+        freeBlocks.erase(best);
+        if (remaining > 0) {
+            freeBlocks[offset + size] = remaining;
+        }
+        return offset;
+    }
+
+    void grow(std::size_t minimumCapacity) {
+        std::size_t newCapacity = capacity * 2;
+        while (newCapacity < minimumCapacity) newCapacity *= 2;
+
+        const std::uint32_t newBuffer = backend.createBuffer(newCapacity);
+        backend.copy(bufferId, newBuffer, capacity);
+        backend.destroyBuffer(bufferId);
+        bufferId = newBuffer;
+
+        // The new space is one hole at the end, merged with a hole the old buffer ended in
+        const std::size_t oldCapacity = capacity;
+        capacity = newCapacity;
+        ++grows;
+        insertFreeBlock(oldCapacity, newCapacity - oldCapacity);
+    }
+};
+
+#endif // VERTEX_HEAP_H
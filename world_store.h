@@ -0,0 +1,191 @@
+#ifndef WORLD_STORE_H
+#define WORLD_STORE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "region_file.h"
+
+struct WorldStoreStats {
+    std::size_t regions = 0;      // Region files open
+    std::size_t pending = 0;      // Saves queued and not written yet
+    std::uint64_t loads = 0;      // Chunks read back instead of generated
+    std::uint64_t saves = 0;      // Chunks written to disk
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t compactions = 0; // Region files rewritten without their dead records
+};
+
+// Saved chunks on disk, in region files of REGION_SIZE x REGION_SIZE chunks under one directory. The store only
+// moves bytes around, what is in them is up to Chunk::serialize(). save() just queues the data for a writer thread
+// of the store's own, so callers never wait for the disk; a chunk loaded while its save is still queued is read from
+// the queue.
+class WorldStore {
+public:
+    explicit WorldStore(std::filesystem::path directory) : directory(std::move(directory)) {
+        std::error_code error;
+        std::filesystem::create_directories(this->directory, error);
+        if (error) {
+            std::cout << "Failed to create world directory " << this->directory << ": " << error.message() << std::endl;
+        }
+        writer = std::thread([this] { run(); });
+    }
+
+    ~WorldStore() {
+        shutdown();
+    }
+
+    WorldStore(const WorldStore&) = delete;
+    WorldStore& operator=(const WorldStore&) = delete;
+
+    // Calls fn(data, size) with the saved data of a chunk and returns its result, false without calling fn if the
+    // chunk was never saved
+    template <typename Fn>
+    bool load(int chunkX, int chunkZ, Fn&& fn) {
+        std::shared_ptr<const std::vector<std::uint8_t>> queued;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            auto it = pending.find({chunkX, chunkZ});
+            if (it != pending.end()) {
+                queued = it->second;
+            }
+        }
+        bool loaded;
+        if (queued) {
+            loaded = fn(queued->data(), queued->size());
+        } else {
+            RegionFile* file = region(regionOf(chunkX), regionOf(chunkZ), false);
+            loaded = file && file->read(chunkX - regionOf(chunkX) * REGION_SIZE, chunkZ - regionOf(chunkZ) * REGION_SIZE, fn);
+        }
+        if (loaded) {
+            loads.fetch_add(1, std::memory_order_relaxed);
+        }
+        return loaded;
+    }
+
+    // Queues a chunk's data for writing, replacing an older save of the same chunk that wasn't written yet
+    void save(int chunkX, int chunkZ, std::vector<std::uint8_t> data) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            pending[{chunkX, chunkZ}] = std::make_shared<const std::vector<std::uint8_t>>(std::move(data));
+        }
+        queueChanged.notify_all();
+    }
+
+    // Waits until everything queued so far is on disk
+    void flush() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueChanged.wait(lock, [this] { return pending.empty() || stopped; });
+    }
+
+    // Writes out what is still queued and stops the writer
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (stopping) return;
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        if (writer.joinable()) writer.join();
+    }
+
+    WorldStoreStats stats() {
+        WorldStoreStats result;
+        {
+            std::lock_guard<std::mutex> lock(regionsMutex);
+            result.regions = regions.size();
+            for (const auto& [position, file] : regions) {
+                result.compactions += file ? file->compactions() : 0;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            result.pending = pending.size();
+        }
+        result.loads = loads.load(std::memory_order_relaxed);
+        result.saves = saves.load(std::memory_order_relaxed);
+        result.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    static int regionOf(int chunk) {
+        return chunk >= 0 ? chunk / REGION_SIZE : (chunk + 1) / REGION_SIZE - 1;
+    }
+
+private:
+    using Position = std::pair<int, int>;
+
+    const std::filesystem::path directory;
+    std::mutex regionsMutex;
+    std::map<Position, std::unique_ptr<RegionFile>> regions; // Null for a region file that failed to open
+
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    // Saves not written yet. An entry stays until its data is on disk, so loads keep finding it meanwhile.
+    std::map<Position, std::shared_ptr<const std::vector<std::uint8_t>>> pending;
+    bool stopping = false;
+    bool stopped = false;
+    std::thread writer;
+
+    std::atomic<std::uint64_t> loads{0};
+    std::atomic<std::uint64_t> saves{0};
+    std::atomic<std::uint64_t> bytesWritten{0};
+
+    // Opened on first use and kept open. Loads don't create files, so looking for chunks that were never saved
+    // leaves nothing behind on disk.
+    RegionFile* region(int regionX, int regionZ, bool create) {
+        std::lock_guard<std::mutex> lock(regionsMutex);
+        auto it = regions.find({regionX, regionZ});
+        if (it == regions.end()) {
+            const std::filesystem::path path = directory / ("r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".region");
+            if (!create && !std::filesystem::exists(path)) {
+                return nullptr;
+            }
+            it = regions.emplace(std::make_pair(regionX, regionZ), RegionFile::open(path.string())).first;
+            if (!it->second) {
+                std::cout << "Failed to open region file " << path << std::endl;
+            }
+        }
+        return it->second.get();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queueChanged.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                break; // Only once stopping and everything is written
+            }
+            const auto [position, data] = *pending.begin();
+            lock.unlock();
+
+            const auto [chunkX, chunkZ] = position;
+            RegionFile* file = region(regionOf(chunkX), regionOf(chunkZ), true);
+            if (file && file->write(chunkX - regionOf(chunkX) * REGION_SIZE, chunkZ - regionOf(chunkZ) * REGION_SIZE, data->data(), data->size())) {
+                saves.fetch_add(1, std::memory_order_relaxed);
+                bytesWritten.fetch_add(data->size(), std::memory_order_relaxed);
+            }
+
+            lock.lock();
+            // A newer save of the same chunk queued meanwhile stays for the next round
+            auto it = pending.find(position);
+            if (it != pending.end() && it->second == data) {
+                pending.erase(it);
+            }
+            queueChanged.notify_all();
+        }
+        stopped = true;
+        queueChanged.notify_all();
+    }
+};
+
+#endif // WORLD_STORE_H
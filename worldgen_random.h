@@ -0,0 +1,51 @@
+#ifndef WORLDGEN_RANDOM_H
+#define WORLDGEN_RANDOM_H
+
+#include <cstdint>
+
+// What a random number is drawn for. Every feature gets its own stream, so adding draws for one feature never
+// shifts the numbers another feature sees.
+enum class WorldFeature : std::uint32_t {
+    Tree = 1,
+    Cactus = 2,
+    CactusHeight = 3
+};
+
+// SplitMix64 finaliser, a full avalanche of all 64 bits
+constexpr std::uint64_t splitMix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Stateless random numbers for world generation. A value is a pure hash of (seed, chunk, feature, index), so a
+// chunk generates the same way on any thread, in any order and any number of times, and nothing is shared or
+// locked between chunks. index tells apart the draws of one feature, usually a block or column index.
+class WorldRandom {
+public:
+    constexpr WorldRandom(std::uint64_t seed, int chunkX, int chunkZ)
+        : chunkKey(splitMix64(splitMix64(seed ^ static_cast<std::uint32_t>(chunkX)) ^ static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunkZ)) << 32)) {}
+
+    constexpr std::uint64_t next(WorldFeature feature, std::uint32_t index) const {
+        return splitMix64(chunkKey ^ (static_cast<std::uint64_t>(feature) << 32 | index));
+    }
+
+    // Uniform in [0, bound)
+    constexpr int nextInt(WorldFeature feature, std::uint32_t index, int bound) const {
+        return static_cast<int>(next(feature, index) % static_cast<std::uint64_t>(bound));
+    }
+
+    // True with the given chance out of 100
+    constexpr bool percent(WorldFeature feature, std::uint32_t index, int chance) const {
+        return nextInt(feature, index, 100) < chance;
+    }
+
+private:
+    std::uint64_t chunkKey;
+};
+
+static_assert(WorldRandom(1, 0, 0).next(WorldFeature::Tree, 0) != WorldRandom(1, 0, 1).next(WorldFeature::Tree, 0));
+static_assert(WorldRandom(1, 2, 3).next(WorldFeature::Tree, 7) == WorldRandom(1, 2, 3).next(WorldFeature::Tree, 7));
+
+#endif // WORLDGEN_RANDOM_H